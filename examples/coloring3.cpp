@@ -258,15 +258,29 @@ int main(int argc,char* argv[])
 
    std::cout << "LABELS:" << labels << "\n";
 
-   BAndB engine(DD<COLOR,Minimize<double>, // to minimize
-                ///decltype(init), 
-                decltype(target),
-                decltype(lgf),
-                decltype(stf),
-                decltype(scf),
-                decltype(smf),
-                decltype(eqs)
-                >::makeDD(init,target,lgf,stf,scf,smf,eqs,labels),w);
+   auto theDD = DD<COLOR,Minimize<double>, // to minimize
+                   ///decltype(init), 
+                   decltype(target),
+                   decltype(lgf),
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(eqs)
+                   >::makeDD(init,target,lgf,stf,scf,smf,eqs,labels);
+   theDD->setMergeKey([](const COLOR& s) { // smf only merges states with the same last/vtx
+      return ((std::size_t)s.last << 32) | (unsigned)s.vtx;
+   });
+   theDD->setNaryMerge([](std::span<const COLOR* const> g) -> std::optional<COLOR> { // smf on a whole group
+      const auto& f = *g[0];
+      Legal B(f.s);
+      for(auto s : g.subspan(1)) {
+         if (s->last != f.last || s->vtx != f.vtx) return std::nullopt;
+         for(auto i=0;i < f.vtx + 1;i++) 
+            B[i] = (B[i] == s->s[i]) ? B[i] : 0;
+      }
+      return COLOR { std::move(B) , f.last, f.vtx};
+   });
+   BAndB engine(theDD,w);
    engine.setTimeLimit([](double elapsed) { return elapsed >= 300000;});
    engine.search(bnds);
    return 0;
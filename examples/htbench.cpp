@@ -0,0 +1,174 @@
+#include "codd.hpp"
+#include "lighthash.hpp"
+#include "conchash.hpp"
+#include "RuntimeMonitor.hpp"
+#include <thread>
+#include <mutex>
+#include <random>
+
+// Microbenchmark of the state-interning tables: LHashtable (behind a mutex when shared) vs CHashtable.
+// The states are those of the MISP and TSP examples, produced by random walks through their transition
+// functions so that the workload has the duplicates a DD compilation sees (many paths reach the same state).
+
+struct MISP {
+   GNSet sel;
+   int   n;
+   int   l;
+};
+
+template<> struct std::equal_to<MISP> {
+   bool operator()(const MISP& s1,const MISP& s2) const {
+      return s1.sel == s2.sel && s1.n == s2.n && s1.l == s2.l;
+   }
+};
+
+template<> struct std::hash<MISP> {
+   std::size_t operator()(const MISP& v) const noexcept {
+      return std::rotl(std::hash<GNSet>{}(v.sel),32) ^ std::hash<int>{}(v.n) ^ std::hash<int>{}(v.l);
+   }
+};
+
+std::ostream& operator<<(std::ostream& os,const MISP& m) {
+   return os << "<" << m.sel << ',' << m.n << ',' << m.l << ">";
+}
+
+struct TSP {
+   GNSet A;
+   int e;
+   int hops;
+};
+
+template<> struct std::equal_to<TSP> {
+   bool operator()(const TSP& s1,const TSP& s2) const {
+      return s1.e == s2.e && s1.hops==s2.hops && s1.A == s2.A;
+   }
+};
+
+template<> struct std::hash<TSP> {
+   std::size_t operator()(const TSP& v) const noexcept {
+      return (std::hash<GNSet>{}(v.A) << 32) | (std::hash<int>{}(v.e) << 16) | std::hash<int>{}(v.hops);
+   }
+};
+
+std::ostream& operator<<(std::ostream& os,const TSP& m) {
+   return os << "<" << m.A << ',' << m.e << ',' << m.hops << ">";
+}
+
+std::vector<MISP> mispStates(int nv,double density,unsigned nbWalks,std::mt19937& rng)
+{
+   std::vector<GNSet> nbr(nv,GNSet(nv));
+   std::uniform_real_distribution<double> coin(0,1);
+   for(int i=0;i < nv;i++) {
+      nbr[i].insert(i);
+      for(int j=i+1;j < nv;j++)
+         if (coin(rng) < density) {
+            nbr[i].insert(j);
+            nbr[j].insert(i);
+         }
+   }
+   std::vector<MISP> out;
+   for(auto w=0u;w < nbWalks;w++) {
+      MISP s { GNSet(0,nv-1),0,-1 };
+      while (true) { // the transition of misp.cpp on a random label above the last one
+         std::vector<int> lbl;
+         for(auto v : s.sel)
+            if (v > s.l) lbl.push_back(v);
+         if (lbl.empty()) break;
+         const int label = lbl[std::uniform_int_distribution<int>(0,std::min<int>(lbl.size(),4)-1)(rng)];
+         GNSet sel = s.sel;
+         for(auto v : s.sel)
+            if (nbr[label].contains(v) || v < label)
+               sel.remove(v);
+         s = MISP { std::move(sel),s.n + 1,label };
+         out.push_back(s);
+      }
+   }
+   return out;
+}
+
+std::vector<TSP> tspStates(int nc,int depth,unsigned nbWalks,std::mt19937& rng)
+{
+   std::vector<TSP> out;
+   for(auto w=0u;w < nbWalks;w++) {
+      TSP s { GNSet{0},0,0 };
+      for(int h=0;h < depth;h++) { // the transition of tsp_test4.cpp on a random unvisited city
+         int label;
+         do label = std::uniform_int_distribution<int>(1,nc-1)(rng);
+         while (s.A.contains(label));
+         s = TSP { s.A | GNSet{label},label,s.hops + 1 };
+         out.push_back(s);
+      }
+   }
+   return out;
+}
+
+template <class ST>
+void runThreads(unsigned nbt,const std::vector<ST>& states,std::function<void(unsigned,const ST&)> op)
+{
+   std::vector<std::thread> thr;
+   for(auto t=0u;t < nbt;t++)
+      thr.emplace_back([t,nbt,&states,&op]() {
+         for(auto i = t;i < states.size();i += nbt)
+            op(t,states[i]);
+      });
+   for(auto& t : thr)
+      t.join();
+}
+
+template <class ST>
+void bench(const char* name,const std::vector<ST>& states,const std::vector<unsigned>& nbThreads)
+{
+   const std::size_t nbOps = states.size();
+   const auto report = [name,nbOps](const char* tab,unsigned nbt,unsigned nbn,double ms) {
+      std::cout << name << "\t" << tab << "\tT=" << nbt << "\tops=" << nbOps << "\tnodes=" << nbn
+                << "\ttime=" << ms << "ms\t" << (ms > 0 ? nbOps / ms / 1000 : 0) << " Mops/s\n";
+   };
+   for(auto nbt : nbThreads) {
+      {  // LHashtable: one table, one pool, one lock
+         Pool pool;
+         LHashtable<ST> tab(&pool,nbOps / 4);
+         std::mutex mtx;
+         unsigned nid = 0;
+         auto start = RuntimeMonitor::now();
+         runThreads<ST>(nbt,states,[&](unsigned,const ST& s) {
+            std::lock_guard<std::mutex> lock(mtx);
+            Node<ST>* at = nullptr;
+            auto loc = tab.getLoc(s,at);
+            if (!loc)
+               tab.safeInsertAt(loc,new (&pool) Node<ST>(&pool,ST(s),nid++,true));
+         });
+         report("LHashtable+mutex",nbt,tab.size(),RuntimeMonitor::elapsedSince(start));
+      }
+      {  // CHashtable: one pool per thread for the nodes themselves
+         std::vector<std::unique_ptr<Pool>> pools;
+         for(auto t=0u;t < nbt;t++)
+            pools.emplace_back(new Pool);
+         CHashtable<ST> tab(nbOps / 4);
+         std::atomic<unsigned> nid = 0;
+         auto start = RuntimeMonitor::now();
+         runThreads<ST>(nbt,states,[&](unsigned t,const ST& s) {
+            tab.intern(s,[&]() {
+               return new (pools[t].get()) Node<ST>(pools[t].get(),ST(s),nid++,true);
+            });
+         });
+         report("CHashtable",nbt,tab.size(),RuntimeMonitor::elapsedSince(start));
+      }
+   }
+}
+
+int main(int argc,char* argv[])
+{
+   std::vector<unsigned> nbThreads { 1, 8, 32 };
+   if (argc > 1) {
+      nbThreads.clear();
+      for(int i=1;i < argc;i++)
+         nbThreads.push_back((unsigned)atoi(argv[i]));
+   }
+   std::mt19937 rng(42);
+   auto ms = mispStates(200,0.05,20000,rng);
+   auto ts = tspStates(60,6,200000,rng);
+   std::cout << "MISP: " << ms.size() << " states\tTSP: " << ts.size() << " states\n";
+   bench("MISP",ms,nbThreads);
+   bench("TSP",ts,nbThreads);
+   return 0;
+}
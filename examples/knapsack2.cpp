@@ -146,14 +146,18 @@ int main(int argc,char* argv[])
    const auto sEq = [I](const SKS& s) -> bool              { return s.n == I;};
    const auto sDom = [](const SKS& a,const SKS& b) -> bool { return  a.n == b.n && a.c >= b.c;};
    
-   BAndB engine(DD<SKS,Maximize<double>,
-                decltype(target),
-                decltype(lgf),
-                decltype(stf),
-                decltype(scf),
-                decltype(smf),
-                decltype(sEq)
-                >::makeDD(init,target,lgf,stf,scf,smf,sEq,labels,local,sDom),width);
+   const auto sKey = [](const SKS& s) -> DomKey     { return DomKey { (std::size_t)s.n,(double)s.c};};
+
+   auto theDD = DD<SKS,Maximize<double>,
+                   decltype(target),
+                   decltype(lgf),
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(sEq)
+                   >::makeDD(init,target,lgf,stf,scf,smf,sEq,labels,local,sDom);
+   theDD->setDominanceKey(sKey);
+   BAndB engine(theDD,width);
    engine.search(bnds);
    return 0;
 }
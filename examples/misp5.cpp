@@ -89,11 +89,12 @@ int main(int argc,char* argv[])
 {
    // using STL containers for the graph
    if (argc < 2) {
-      std::cout << "usage: coloring <fname> <width>\n";
+      std::cout << "usage: coloring <fname> <width> [<#workers>]\n";
       exit(1);
    }
    const char* fName = argv[1];
-   const int w = argc==3 ? atoi(argv[2]) : 64;
+   const int w = argc>=3 ? atoi(argv[2]) : 64;
+   const int nbw = argc==4 ? atoi(argv[3]) : 1;
    auto instance = readFile(fName);
    
    const GNSet ns = instance.vertices();
@@ -183,7 +184,7 @@ int main(int argc,char* argv[])
                 decltype(smf),
                 decltype(eqs),
                 decltype(local)
-                >::makeDD(myInit,myTarget,lgf,myStf,scf,smf,eqs,labels,local),w);
+                >::makeDD(myInit,myTarget,lgf,myStf,scf,smf,eqs,labels,local),w,nbw);
    engine.search(bnds);
    return 0;
 }
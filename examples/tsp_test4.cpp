@@ -192,12 +192,16 @@ double greedy(Matrix<double,2>& d,GNSet C,GNSet V,int src,int sink,int hops)
 
 int main(int argc,char* argv[]) {
    if (argc < 3) {
-      std::cout << "usage: tsp <file> <width>\n";
+      std::cout << "usage: tsp <file> <width>[a|d|e|l|p<k>][,<width>[a|d|e|l|p<k>]...] [<#workers>] [<budget(MB)>] [<checkpoint>]\n";
+      std::cout << "\t(a: adaptive widths, d: depth-first plunging, e: best-estimate plunging, l: last exact layer cutset,\n\t p<k>: k threads per DD compilation)\n";
       exit(1);
    }
    const char* fName = argv[1];
    std::cout << "FILE:" << fName << "\n";
-   const int w = argc==3 ? atoi(argv[2]) : 64;
+   const int w = argc>=3 ? atoi(argv[2]) : 64;
+   const int nbw = argc>=4 ? atoi(argv[3]) : 1;
+   const std::size_t mb = argc>=5 ? atoi(argv[4]) : 0;
+   const char* ckName = argc==6 ? argv[5] : nullptr;
    Instance instance = readFile(fName);
    auto C = instance.vertices();
    auto& d = instance.d; 
@@ -251,15 +255,76 @@ int main(int argc,char* argv[]) {
       //return greedyVal;
    };   
 
-   BAndB engine(DD<TSP,Minimize<double>,
-                decltype(target),
-                decltype(lgf),
-                decltype(stf),
-                decltype(scf),
-                decltype(smf),
-                decltype(eqs),
-                decltype(local)
-                >::makeDD(init,target,lgf,stf,scf,smf,eqs,C,local),w);
+   const auto sWrite = [](std::ostream& os,const TSP& s) {
+      s.A.write(os);
+      writeBin(os,s.e);
+      writeBin(os,s.hops);
+   };
+   const auto sRead = [](std::istream& is) {
+      auto A = GNSet::read(is);
+      auto e = readBin<int>(is);
+      return TSP { std::move(A),e,readBin<int>(is) };
+   };
+   auto theDD = DD<TSP,Minimize<double>,
+                   decltype(target),
+                   decltype(lgf),
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(eqs),
+                   decltype(local)
+                   >::makeDD(init,target,lgf,stf,scf,smf,eqs,C,local);
+   theDD->setStateSerializer(sWrite,sRead);
+   theDD->setLocalCache(1 << 18); // mst/greedy only depend on the state
+   theDD->setMergeKey([](const TSP& s) { // smf only merges states with the same e/hops
+      return ((std::size_t)s.e << 32) | (unsigned)s.hops;
+   });
+   theDD->setNaryMerge([](std::span<const TSP* const> g) -> std::optional<TSP> { // smf on a whole group
+      GNSet A = g[0]->A;
+      int lo = A.size(),hi = lo;
+      for(auto s : g.subspan(1)) {
+         if (s->e != g[0]->e || s->hops != g[0]->hops) return std::nullopt;
+         A.interWith(s->A);
+         lo = std::min(lo,s->A.size());
+         hi = std::max(hi,s->A.size());
+      }
+      if (hi - lo >= 5) return std::nullopt;
+      return TSP {std::move(A), g[0]->e, g[0]->hops};
+   });
+   const auto config = [nbw](const char* p) { // <width> followed by option letters
+      char* e = nullptr;
+      BBConfig c { (unsigned)strtol(p,&e,10),0,true,(unsigned)nbw };
+      for(;*e && *e != ',';e++)
+         switch(*e) {
+            case 'a': c.adaptive = true;break;
+            case 'd': c.selection = std::make_shared<DepthFirst>();break;
+            case 'e': c.selection = std::make_shared<BestEstimate>();break;
+            case 'l': c.cutSet = CSLastExactLayer;break;
+            case 'p': c.nbCompile = (unsigned)strtol(e + 1,&e,10);e--;break;
+         }
+      return c;
+   };
+   if (strchr(argv[2],',')) { // several widths: run them as a portfolio
+      Portfolio pf(theDD);
+      for(const char* p = argv[2];p;p = strchr(p,',') ? strchr(p,',') + 1 : nullptr)
+         pf.add(config(p));
+      pf.search(bnds);
+      return 0;
+   }
+   const auto cfg = config(argv[2]);
+   BAndB engine(theDD,w,nbw);
+   engine.setAdaptiveWidth(cfg.adaptive);
+   engine.setNodeSelection(cfg.selection);
+   engine.setCutSet(cfg.cutSet);
+   engine.setCompileThreads(cfg.nbCompile);
+   engine.setMemoryBudget(mb << 20);
+   if (ckName) {
+      engine.setCheckpoint(ckName,60);
+      if (std::ifstream(ckName).good()) {
+         engine.resume(bnds,ckName);
+         return 0;
+      }
+   }
    engine.search(bnds);
    return 0;
 }
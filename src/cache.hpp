@@ -0,0 +1,156 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_CACHE_H
+#define __DDOPT_CACHE_H
+
+#include <unordered_map>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Bounded map with CLOCK (second chance) eviction.
+ * Keys are copied in the map. Once `capacity()` entries are present, inserting a new key
+ * evicts the first entry of the clock that was not referenced since the hand last passed it.
+ * A capacity of 0 means unbounded. Lookups and insertions are counted to report hit rates.
+ */
+template <class K,class V,class Hash = std::hash<K>,class Equal = std::equal_to<K>> class ClockCache {
+   struct Entry {
+      V    _val;
+      bool _ref;
+   };
+   typedef std::unordered_map<K,Entry,Hash,Equal> Map;
+   Map                  _map;
+   std::deque<const K*> _clock; // keys in insertion order. Front is the hand.
+   std::size_t          _cap;
+   std::size_t          _hits,_misses,_evicted;
+   void evict() {
+      while (!_clock.empty()) {
+         const K* k = _clock.front();
+         _clock.pop_front();
+         auto at = _map.find(*k);
+         if (at->second._ref) {
+            at->second._ref = false; // second chance
+            _clock.push_back(k);
+         } else {
+            _map.erase(at);
+            ++_evicted;
+            return;
+         }
+      }
+   }
+public:
+   ClockCache(std::size_t cap = 0) : _cap(cap),_hits(0),_misses(0),_evicted(0) {}
+   std::size_t size() const noexcept     { return _map.size();}
+   std::size_t capacity() const noexcept { return _cap;}
+   void setCapacity(std::size_t cap) {
+      _cap = cap;
+      while (_cap && _map.size() > _cap)
+         evict();
+   }
+   /**
+    * @return a pointer to the value bound to `k` (marking it as referenced) or nullptr.
+    * With transparent `Hash` and `Equal`, `k` may be any type they accept (no key copy).
+    */
+   template <class Q = K> V* find(const Q& k) {
+      auto at = _map.find(k);
+      if (at == _map.end()) {
+         ++_misses;
+         return nullptr;
+      }
+      ++_hits;
+      at->second._ref = true;
+      return &at->second._val;
+   }
+   /**
+    * Binds `k` to `v`. A key already present is rebound (it keeps its place in the clock).
+    * @return a reference to the stored value.
+    */
+   V& insert(const K& k,const V& v) {
+      auto in = _map.find(k);
+      if (in != _map.end())
+         return in->second._val = v;
+      if (_cap && _map.size() >= _cap)
+         evict();
+      auto [at,ok] = _map.emplace(k,Entry { v, false });
+      _clock.push_back(&at->first);
+      return at->second._val;
+   }
+   void clear() {
+      _map.clear();
+      _clock.clear();
+   }
+   std::size_t hits() const noexcept    { return _hits;}
+   std::size_t misses() const noexcept  { return _misses;}
+   std::size_t evicted() const noexcept { return _evicted;}
+   double hitRate() const noexcept {
+      const auto ttl = _hits + _misses;
+      return ttl ? (double)_hits / ttl : 0.0;
+   }
+   friend std::ostream& operator<<(std::ostream& os,const ClockCache& c) {
+      return os << "<SZ:" << c.size() << "/" << c._cap << " H:" << c._hits << " M:" << c._misses
+                << " E:" << c._evicted << " RATE:" << c.hitRate() << ">";
+   }
+};
+
+/**
+ * @brief Thread-safe ClockCache split in `NbStripes` stripes, each behind its own lock (same striping
+ * as `CHashtable`). A key lives in the stripe picked by its hash and the capacity is spread evenly
+ * over the stripes, so eviction is per stripe.
+ */
+template <class K,class V,class Hash = std::hash<K>,class Equal = std::equal_to<K>> class CClockCache {
+   static constexpr const unsigned NbStripes = 64;
+   struct alignas(64) Stripe {
+      std::mutex                   _mtx;
+      ClockCache<K,V,Hash,Equal>   _tab;
+   };
+   std::unique_ptr<Stripe[]> _stp;
+   std::size_t               _cap;
+   Stripe& stripe(const K& k) const noexcept { return _stp[Hash{}(k) % NbStripes];}
+public:
+   CClockCache(std::size_t cap = 0) : _stp(new Stripe[NbStripes]),_cap(0) { setCapacity(cap);}
+   void setCapacity(std::size_t cap) {
+      _cap = cap;
+      for(auto i=0u;i < NbStripes;i++) {
+         std::lock_guard<std::mutex> lock(_stp[i]._mtx);
+         _stp[i]._tab.setCapacity(cap ? std::max<std::size_t>(1,cap / NbStripes) : 0);
+      }
+   }
+   std::size_t capacity() const noexcept { return _cap;}
+   /**
+    * Runs `f(c)` on the stripe `c` (a ClockCache) holding `k`, under the lock of that stripe.
+    * `f` must not call back into this cache.
+    * @return whatever `f` returns.
+    */
+   template <class Fun> auto update(const K& k,Fun f) {
+      Stripe& s = stripe(k);
+      std::lock_guard<std::mutex> lock(s._mtx);
+      return f(s._tab);
+   }
+   std::size_t size() const {
+      std::size_t ttl = 0;
+      for(auto i=0u;i < NbStripes;i++) {
+         std::lock_guard<std::mutex> lock(_stp[i]._mtx);
+         ttl += _stp[i]._tab.size();
+      }
+      return ttl;
+   }
+};
+
+#endif
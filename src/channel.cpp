@@ -0,0 +1,219 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "channel.hpp"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SIGPIPE is ignored through SO_NOSIGPIPE instead
+#endif
+
+namespace {
+   struct Address {
+      bool        isUnix;
+      std::string path;       // unix
+      std::string host,port;  // tcp
+   };
+
+   bool parse(const std::string& ep,Address& a)
+   {
+      if (ep.rfind("unix:",0) == 0) {
+         a.isUnix = true;
+         a.path = ep.substr(5);
+         return a.path.size() < sizeof(sockaddr_un::sun_path);
+      } else if (ep.rfind("tcp:",0) == 0) {
+         auto c = ep.rfind(':');
+         a.isUnix = false;
+         a.host = ep.substr(4,c - 4);
+         a.port = ep.substr(c + 1);
+         return c >= 4 && !a.port.empty();
+      }
+      return false;
+   }
+
+   sockaddr_un unixAddress(const std::string& path)
+   {
+      sockaddr_un sa;
+      memset(&sa,0,sizeof(sa));
+      sa.sun_family = AF_UNIX;
+      strncpy(sa.sun_path,path.c_str(),sizeof(sa.sun_path) - 1);
+      return sa;
+   }
+
+   int openSocket(const Address& a,bool listening)
+   {
+      if (a.isUnix) {
+         int fd = socket(AF_UNIX,SOCK_STREAM,0);
+         auto sa = unixAddress(a.path);
+         int ok = listening ? bind(fd,(sockaddr*)&sa,sizeof(sa)) : connect(fd,(sockaddr*)&sa,sizeof(sa));
+         if (ok == 0 && (!listening || listen(fd,64) == 0))
+            return fd;
+         close(fd);
+         return -1;
+      }
+      addrinfo hints,*res = nullptr;
+      memset(&hints,0,sizeof(hints));
+      hints.ai_family   = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags    = listening ? AI_PASSIVE : 0;
+      if (getaddrinfo(a.host.empty() ? nullptr : a.host.c_str(),a.port.c_str(),&hints,&res) != 0)
+         return -1;
+      int fd = -1;
+      for(auto p = res;p && fd < 0;p = p->ai_next) {
+         fd = socket(p->ai_family,p->ai_socktype,p->ai_protocol);
+         if (fd < 0) continue;
+         int one = 1;
+         if (listening) {
+            setsockopt(fd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+            if (bind(fd,p->ai_addr,p->ai_addrlen) == 0 && listen(fd,64) == 0)
+               break;
+         } else if (connect(fd,p->ai_addr,p->ai_addrlen) == 0) {
+            setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+            break;
+         }
+         close(fd);
+         fd = -1;
+      }
+      freeaddrinfo(res);
+      return fd;
+   }
+
+   bool writeAll(int fd,const char* buf,std::size_t sz)
+   {
+      while (sz) {
+         auto nb = ::send(fd,buf,sz,MSG_NOSIGNAL);
+         if (nb <= 0) return false;
+         buf += nb;
+         sz  -= nb;
+      }
+      return true;
+   }
+
+   bool readAll(int fd,char* buf,std::size_t sz)
+   {
+      while (sz) {
+         auto nb = ::read(fd,buf,sz);
+         if (nb <= 0) return false;
+         buf += nb;
+         sz  -= nb;
+      }
+      return true;
+   }
+}
+
+Channel::Channel(int fd)
+   : _fd(fd)
+{
+#ifdef SO_NOSIGPIPE
+   int one = 1;
+   setsockopt(_fd,SOL_SOCKET,SO_NOSIGPIPE,&one,sizeof(one));
+#endif
+}
+
+Channel::~Channel()
+{
+   if (_fd >= 0)
+      close(_fd);
+}
+
+Channel::Ptr Channel::connect(const std::string& endpoint,double patience)
+{
+   Address a;
+   if (!parse(endpoint,a)) {
+      std::cerr << "Channel: bad endpoint " << endpoint << "\n";
+      return nullptr;
+   }
+   const auto limit = std::chrono::steady_clock::now() + std::chrono::duration<double>(patience);
+   do {
+      int fd = openSocket(a,false);
+      if (fd >= 0)
+         return std::make_shared<Channel>(fd);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+   } while (std::chrono::steady_clock::now() < limit);
+   std::cerr << "Channel: cannot connect to " << endpoint << "\n";
+   return nullptr;
+}
+
+bool Channel::send(std::uint8_t tag,const std::string& payload)
+{
+   char hdr[5];
+   const std::uint32_t sz = payload.size();
+   hdr[0] = tag;
+   memcpy(hdr + 1,&sz,sizeof(sz));
+   return writeAll(_fd,hdr,sizeof(hdr)) && writeAll(_fd,payload.data(),sz);
+}
+
+bool Channel::ready(int timeout)
+{
+   pollfd p { _fd, POLLIN, 0 };
+   return poll(&p,1,timeout) > 0;
+}
+
+bool Channel::recv(std::uint8_t& tag,std::string& payload)
+{
+   char hdr[5];
+   if (!readAll(_fd,hdr,sizeof(hdr)))
+      return false;
+   std::uint32_t sz;
+   tag = hdr[0];
+   memcpy(&sz,hdr + 1,sizeof(sz));
+   payload.resize(sz);
+   return readAll(_fd,payload.data(),sz);
+}
+
+Listener::Listener(const std::string& endpoint)
+   : _fd(-1)
+{
+   Address a;
+   if (!parse(endpoint,a)) {
+      std::cerr << "Listener: bad endpoint " << endpoint << "\n";
+      return;
+   }
+   if (a.isUnix) {
+      unlink(a.path.c_str());
+      _path = a.path;
+   }
+   _fd = openSocket(a,true);
+   if (_fd < 0)
+      std::cerr << "Listener: cannot listen on " << endpoint << "\n";
+}
+
+Listener::~Listener()
+{
+   if (_fd >= 0)
+      close(_fd);
+   if (!_path.empty())
+      unlink(_path.c_str());
+}
+
+Channel::Ptr Listener::accept()
+{
+   int fd = ::accept(_fd,nullptr,nullptr);
+   if (fd < 0)
+      return nullptr;
+   int one = 1;
+   setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one)); // harmless failure on Unix sockets
+   return std::make_shared<Channel>(fd);
+}
@@ -0,0 +1,65 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_CHANNEL_H
+#define __DDOPT_CHANNEL_H
+
+#include <memory>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Framed message channel over a stream socket.
+ * Endpoints read `unix:<path>` (Unix domain socket) or `tcp:<host>:<port>`.
+ * A frame is a one byte tag, a 32 bit payload size and the payload.
+ */
+class Channel {
+   int _fd;
+public:
+   typedef std::shared_ptr<Channel> Ptr;
+   Channel(int fd);
+   ~Channel();
+   /**
+    * Connects to a listening endpoint. Retries for `patience` seconds (the listener may not be up yet).
+    * @return the channel or nullptr.
+    */
+   static Channel::Ptr connect(const std::string& endpoint,double patience = 10);
+   int fd() const noexcept { return _fd;}
+   bool send(std::uint8_t tag,const std::string& payload);
+   /**
+    * @return true when a frame (or the end of the stream) can be read within `timeout` milliseconds.
+    */
+   bool ready(int timeout);
+   /**
+    * Blocking read of the next frame.
+    * @return false on end of stream or error.
+    */
+   bool recv(std::uint8_t& tag,std::string& payload);
+};
+
+/**
+ * @brief Listening socket accepting `Channel` connections.
+ */
+class Listener {
+   int         _fd;
+   std::string _path; // Unix domain socket file, if any.
+public:
+   Listener(const std::string& endpoint);
+   ~Listener();
+   bool ok() const noexcept { return _fd >= 0;}
+   Channel::Ptr accept();
+};
+
+#endif
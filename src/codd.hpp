@@ -12,5 +12,6 @@
 #include <algorithm>
 #include <map>
 #include "search.hpp"
+#include "portfolio.hpp"
 
 #endif
@@ -0,0 +1,138 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_CONCHASH_H
+#define __DDOPT_CONCHASH_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "node.hpp"
+
+/**
+ * @brief Concurrent state-interning table (the thread-safe counterpart of `LHashtable`).
+ *
+ * Maps a state to its canonical `Node<ST>*`. Lookups are lock-free: a chain is only ever extended at its
+ * head, with a release store, and chain cells are immutable once published. Insertions lock one of
+ * `NbStripes` stripes, rescan the part of the chain added since the lock-free scan and only then create the
+ * node. So two threads interning the same state always obtain the same node and the node is created once.
+ * Chain cells come from per-stripe blocks (not from the DD `Pool`, which is single-threaded) and are recycled
+ * by `clear`, which uses the same magic number trick as `LHashtable` and must not run concurrently with
+ * `intern`.
+ */
+template <class ST,class Hash = std::hash<ST>,class Equal = std::equal_to<ST>> class CHashtable {
+   struct HTNode {
+      Node<ST>*   _data;
+      std::size_t _hash;
+      HTNode*     _next;
+   };
+   static constexpr const unsigned NbStripes = 64;
+   static constexpr const unsigned BlockSize = 512;
+   struct alignas(64) Stripe {
+      std::mutex                             _mtx;
+      std::vector<std::unique_ptr<HTNode[]>> _blocks;
+      unsigned                               _used = 0;         // blocks in use
+      unsigned                               _top = BlockSize;  // next free cell in the last one
+      HTNode* allocate() {
+         if (_top == BlockSize) {
+            if (_used == _blocks.size())
+               _blocks.emplace_back(new HTNode[BlockSize]);
+            ++_used;
+            _top = 0;
+         }
+         return _blocks[_used - 1].get() + _top++;
+      }
+      void clear() noexcept { _used = 0;_top = BlockSize;}
+   };
+   std::size_t                            _mxs;
+   std::unique_ptr<std::atomic<HTNode*>[]> _tab;
+   std::unique_ptr<std::atomic<unsigned>[]> _mgc;
+   std::unique_ptr<Stripe[]>              _stp;
+   unsigned                               _magic;
+   std::atomic<unsigned>                  _nbp;
+   HTNode* head(std::size_t at) const noexcept {
+      return _mgc[at].load(std::memory_order_acquire) == _magic ? _tab[at].load(std::memory_order_acquire) : nullptr;
+   }
+   static Node<ST>* scan(HTNode* from,HTNode* to,std::size_t h,const ST& key) noexcept {
+      for(HTNode* cur = from;cur != to;cur = cur->_next)
+         if (cur->_hash == h && Equal{}(cur->_data->get(),key))
+            return cur->_data;
+      return nullptr;
+   }
+public:
+   CHashtable(std::size_t sz)
+      : _mxs(std::max<std::size_t>(sz,NbStripes) | 1),
+        _tab(new std::atomic<HTNode*>[_mxs]),
+        _mgc(new std::atomic<unsigned>[_mxs]),
+        _stp(new Stripe[NbStripes]),
+        _magic(1),
+        _nbp(0)
+   {
+      for(auto i=0u;i < _mxs;i++) {
+         _tab[i].store(nullptr,std::memory_order_relaxed);
+         _mgc[i].store(0,std::memory_order_relaxed);
+      }
+   }
+   /**
+    * Lock-free lookup.
+    * @return the canonical node of `key` or nullptr.
+    */
+   Node<ST>* find(const ST& key) const noexcept {
+      const std::size_t h = Hash{}(key);
+      return scan(head(h % _mxs),nullptr,h,key);
+   }
+   /**
+    * Insert-if-absent. `make()` creates the node and is only called when `key` is absent. It runs under the
+    * lock of the stripe of `key`, so it may run concurrently with `make()` calls for states of other stripes.
+    * @return the canonical node and whether this call inserted it.
+    */
+   template <class Fun>
+   std::pair<Node<ST>*,bool> intern(const ST& key,Fun make) {
+      const std::size_t h = Hash{}(key);
+      const std::size_t at = h % _mxs;
+      HTNode* seen = head(at);
+      if (auto n = scan(seen,nullptr,h,key))
+         return {n,false};
+      Stripe& s = _stp[at % NbStripes];
+      std::lock_guard<std::mutex> lock(s._mtx);
+      HTNode* cur = head(at);
+      if (auto n = scan(cur,seen,h,key)) // only the cells added since the first scan
+         return {n,false};
+      Node<ST>* value = make();
+      HTNode* cell = s.allocate();
+      *cell = HTNode { value, h, cur };
+      _tab[at].store(cell,std::memory_order_release);
+      _mgc[at].store(_magic,std::memory_order_release);
+      _nbp.fetch_add(1,std::memory_order_relaxed);
+      return {value,true};
+   }
+   unsigned size() const noexcept { return _nbp.load(std::memory_order_relaxed);}
+   void clear() noexcept {
+      ++_magic;
+      _nbp.store(0,std::memory_order_relaxed);
+      for(auto i=0u;i < NbStripes;i++)
+         _stp[i].clear();
+   }
+   template <class Fun>
+   void doOnAll(Fun f) {
+      for(auto i=0u;i < _mxs;i++)
+         for(HTNode* cur = head(i);cur;cur = cur->_next)
+            f(cur->_data);
+   }
+};
+
+#endif
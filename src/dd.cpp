@@ -8,7 +8,6 @@
 #include <cstdio>
 #include <unistd.h>
 #include "heap.hpp"
-#include "queue.hpp"
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <stdlib.h>
@@ -22,6 +21,7 @@ Bounds::Bounds(std::shared_ptr<AbstractDD> dd)
 
 void Bounds::attach(std::shared_ptr<AbstractDD> dd)
 {
+   std::lock_guard<std::mutex> lock(_mtx); // concurrent searches (portfolio) attach the same bounds
    if (!_primalSet) {
       _primal = dd->initialBest();
       _primalSet = true;
@@ -29,7 +29,7 @@ void Bounds::attach(std::shared_ptr<AbstractDD> dd)
 }
 
 AbstractDD::AbstractDD(const GNSet& labels)
-   : _mem(new Pool),_labels(labels),_exact(true)
+   : _mem(new Pool),_labels(labels),_exact(true),_streamPeak(0)
 {}
 
 AbstractDD::~AbstractDD()
@@ -44,6 +44,14 @@ void AbstractDD::addArc(Edge::Ptr e)
    e->_to->addArc(e);
 }
 
+void AbstractDD::removeArc(Edge::Ptr e)
+{
+   auto& kids = e->_from->_children;
+   kids.remove(e->_fix,[e](Edge::Ptr o) { o->_fix = e->_fix;});
+   auto& pars = e->_to->_parents;
+   pars.remove(e->_tix,[e](Edge::Ptr o) { o->_tix = e->_tix;});
+}
+
 void display(AbstractDD* dd)
 {
    dd->display();
@@ -58,6 +66,7 @@ void AbstractDD::setStrategy(Strategy* s)
 void AbstractDD::compute(Bounds& bnds)
 {
    assert(_strat);
+   _fz.thaw();
    _strat->compute(bnds);
    //computeBestBackward(_strat->getName());
 }
@@ -74,15 +83,19 @@ bool AbstractDD::apply(ANode::Ptr from,Bounds& bnds)
 
 std::vector<int> AbstractDD::incumbent()
 {
-   std::vector<int> inc {};
-   for(auto it= _trg->beginOptLabels();it != _trg->endOptLabels();it++)
-      inc.push_back(*it);
-   return inc;
+   return _trg->optLabels();
 }
 
-std::vector<ANode::Ptr> AbstractDD::computeCutSet()
+std::vector<ANode::Ptr> AbstractDD::computeCutSet(Bounds& bnds)
 {
-   return _strat->computeCutSet();
+   return _strat->computeCutSet(bnds);
+}
+
+void AbstractDD::expandLayer(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc)
+{
+   if (_tp && _tp->size() > 1 && layer.size() > 1)
+      expandParallel(bnds,layer,c,arc);
+   else expandSerial(bnds,layer,c,arc);
 }
 
 struct DNode {
@@ -195,51 +208,30 @@ void AbstractDD::display()
    //unlink(buf);
 }
 
-typedef Heap<DNode> DegHeap;
-
 void AbstractDD::computeBest(const std::string m)
 {
-   //assert(false); // LDMFIX
-   //std::cout << "ANSZ:" << _an.size() << "\n";
-   DegHeap h(_mem,1000,[](const DNode& a,const DNode& b) { return a.degree < b.degree;});
-   unsigned mxId = 0;
-   for(auto n : _an) 
-      mxId = std::max(n->getId(),mxId);
-   auto nl = new (_mem) DegHeap::Location*[mxId+1];
-   memset(nl,0,sizeof(DegHeap::Location*)*(mxId+1));
-   for(auto n : _an) {
-      nl[n->getId()] = h.insert({n,n->nbParents()});
-      if (n != _root)
-         n->setBound(initialBest());
-      // [LDM] There is no else. The root MUST retain the bound it had at the start (from B&B node)
-   }
-   h.buildHeap();
-   while (h.size() > 0) {
-      auto n = h.extractMax();
-      double cur = (n.node->nbParents() == 0) ? n.node->getBound() : initialBest();
-      //std::cout << "\tCOMPUTE BEST: " << n.node->getId() << " \033[31;1m" << n.node->getLayer() << "\033[0m #P:" << n.node->nbParents() << "\n";
-      for(auto pi = n.node->beginPar();pi != n.node->endPar();pi++) {
-         Edge::Ptr e = *pi;
-         auto ep = e->_from->_bound + e->_obj;
-         //std::cout << "\t   EDGE:(" << *e << ") SP=" << e->_from->_bound << " EP=" << ep << std::endl;
+   if (!_fz.frozen())
+      _fz.freeze(_an,getLastId() + 1);
+   for(auto i = 0u;i < _fz.size();i++) {
+      auto n = _fz.node(i);
+      // [LDM] The root MUST retain the bound it had at the start (from B&B node)
+      double cur = (n == _root) ? _fz.bound(i) : initialBest();
+      auto best = _fz.inEnd(i);
+      for(auto a = _fz.inBegin(i);a != _fz.inEnd(i);a++) {
+         auto ep = _fz.bound(_fz.src(a)) + _fz.inObj(a);
          if (isBetter(ep,cur)) {
             cur = ep;
-            n.node->_optLabels = e->_from->_optLabels;
-            n.node->_optLabels.push_back(e->_lbl);
+            best = a;
          }
       }
-      //std::cout << "\tCOMPUTED:" << cur << " for " << n.node->getId() << "\tHELD:" << n.node->getBound() << "\n";
-      n.node->setBound(cur);
-      for(auto ki = n.node->beginKids(); ki != n.node->endKids();ki++) {
-         Edge::Ptr k = *ki;
-         auto at = nl[k->_to->getId()];
-         assert(at!=nullptr);
-         h.decrease(at);
-      }
+      _fz.bound(i) = cur;
+      n->setBound(cur);
+      if (best != _fz.inEnd(i))
+         n->setBest(n->parent(best - _fz.inBegin(i)));
    }
 #ifndef _NDEBUG     
    std::cout << '\t' << m << " B@SINK:" << _trg->getBound() << "\tLBL:[";
-   for(auto l : _trg->_optLabels)
+   for(auto l : _trg->optLabels())
       std::cout << l << " "; 
    std::cout << "]" << std::endl;
 #endif   
@@ -247,54 +239,25 @@ void AbstractDD::computeBest(const std::string m)
 
 void AbstractDD::computeBestBackward(const std::string m)
 {
-   DegHeap h(_mem,1000,[](const DNode& a,const DNode& b) { return a.degree < b.degree;});
-   unsigned mxId = 0;
-   for(auto n : _an) 
-      mxId = std::max(n->getId(),mxId);
-   auto nl = new (_mem) DegHeap::Location*[mxId+1];
-   memset(nl,0,sizeof(DegHeap::Location*)*(mxId+1));
-   for(auto n : _an) {
-      nl[n->getId()] = h.insert({n,n->nbChildren()});
-      if (n != _trg)
-         n->setBackwardBound(initialBest());
-      else n->setBackwardBound(0);
-   }
-   h.buildHeap();
-   while (h.size() > 0) {
-      auto n = h.extractMax();
-      double cur = (n.node->nbChildren() == 0) ? n.node->getBackwardBound() : initialBest();
-
-      // std::cout << "\tCOMPUTE START: ";
-      // printNode(std::cout,n.node);
-      // std::cout << " cur = " << cur << "\n";
-      
-      for(auto ci = n.node->beginKids();ci != n.node->endKids();ci++) {
-         Edge::Ptr e = *ci;
-         auto ep = e->_to->_bbound + e->_obj;
-         //std::cout << "\tEDGE:" << *e << " EP=" << ep << std::endl;
-         if (isBetter(ep,cur)) {
+   if (!_fz.frozen())
+      _fz.freeze(_an,getLastId() + 1);
+   for(auto i = _fz.size();i-- > 0;) {
+      auto n = _fz.node(i);
+      double cur = (n == _trg) ? 0 : initialBest();
+      for(auto a = _fz.outBegin(i);a != _fz.outEnd(i);a++) {
+         auto ep = _fz.bbound(_fz.dst(a)) + _fz.outObj(a);
+         if (isBetter(ep,cur))
             cur = ep;
-         }
       }
       if (hasLocal()) {
-         auto dualBound = local(n.node,DDCtx);
+         auto dualBound = local(n,DDCtx);
          if (isBetter(dualBound,cur)) {
             //std::cout << "\tIMPROVED from " << cur << " to " << dualBound << "\n";
             cur = dualBound;
          }
       }
-
-      // std::cout << "\tCOMPUTED:" << cur << " for ";
-      // printNode(std::cout,n.node);
-      // std::cout << "\n";
-      
-      n.node->setBackwardBound(cur);
-      for(auto pi = n.node->beginPar(); pi != n.node->endPar();pi++) {
-         Edge::Ptr k = *pi;
-         auto at = nl[k->_from->getId()];
-         assert(at!=nullptr);
-         h.decrease(at);
-      }
+      _fz.bbound(i) = cur;
+      n->setBackwardBound(cur);
    }
 #ifndef _NDEBUG     
    std::cout << '\t' << m << " BB@ROOT:" << std::fixed << std::setw(7) << _root->getBackwardBound() << " B@SINK:" << _trg->getBound() << std::endl;
@@ -307,61 +270,96 @@ void AbstractDD::computeBestBackward(const std::string m)
 
 void Exact::compute(Bounds& bnds)
 {
+   if (_streaming) {
+      _dd->computeStreaming(bnds,_spill);
+      return;
+   }
    auto root = _dd->init();
    _dd->target();
    _dd->_exact = true;
-   CQueue<ANode::Ptr> qn(32);
-   qn.enQueue(root);
-   while (!qn.empty()) {
-      auto p = qn.deQueue();
-      auto remLabels = _dd->getLabels(p,DDExact);
-      for(auto l : remLabels) {     
-         auto child = _dd->transition(bnds,p,l); // we get back a new node, or an already existing one.
-         if (child) {
-            const bool newNode = child->nbParents()==0; // is this a newly created node?
-            auto theCost = _dd->cost(p,l);
-            Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
-            e->_obj = theCost;
-            _dd->addArc(e); // connect to new node
-            if (!_dd->eqSink(child)) {
-               if (newNode)
-                  qn.enQueue(child);
-            }
-         }
+   _qn.clear();
+   _qn.push(root,0);
+   const auto arc = [this](ANode::Ptr p,int l,ANode::Ptr child,double theCost) {
+      const bool newNode = child->nbParents()==0; // is this a newly created node?
+      Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
+      e->_obj = theCost;
+      _dd->addArc(e); // connect to new node
+      child->setLayer(std::max(child->getLayer(),p->getLayer()+1));
+      if (!_dd->eqSink(child)) {
+         if (newNode)
+            _qn.push(child,_qn.pulledLayer() + 1);
       }
-   }
+      return true;
+   };
+   while (!_qn.empty())
+      _dd->expandLayer(bnds,_qn.pull(),DDExact,arc);
    _dd->computeBest(getName());
 }
 
-NDArray& WidthBounded::pullLayer(CQueue<ANode::Ptr>& qn)
+std::vector<ANode::Ptr>& WidthBounded::pullLayer()
 {
-   ANode::Ptr n = qn.deQueue();
-   _nda.clear();
-   const unsigned cL = n->getLayer();
-   _nda.push_back(n);
-   while(!qn.empty()) {
-      if (qn.peek()->getLayer() != cL)
-         break;
-      n = qn.deQueue();
-      _nda.push_back(n);         
-   }
-   _nda.sort([dd = _dd](const ANode::Ptr& a,const ANode::Ptr& b) { // sort better to worse
-      return dd->isBetter(a->getBound(),b->getBound());
-   });
-   return _nda;
+   _dix.clear();
+   return _qn.pull();
 }
 
-std::size_t WidthBounded::estimate(CQueue<ANode::Ptr>& qn)
+void WidthBounded::enQueue(ANode::Ptr n)
 {
-   ANode::Ptr n = qn.peek();
-   auto layer = n->getLayer();
-   std::size_t nb = 0;
-   qn.doOnAll([layer,&nb](auto aNodeLoc) {
-      // std::cout << "aNodeLoc->value()->getLayer() = " << aNodeLoc->value()->getLayer();
-      // std::cout << " TRG: " << layer << "\n";
-      nb += aNodeLoc->value()->getLayer()==layer;
-   });
-   return nb;
+   const auto at = _qn.push(n,n->getLayer());
+   if (_dd->hasDominanceKey())
+      _dix.insert(_dd->dominanceKey(n),Queued { n,n->getLayer(),at });
+}
+
+ANode::Ptr WidthBounded::checkDominance(ANode::Ptr n,unsigned layer,double nObj)
+{
+   const auto isDom = [dd = _dd,n,layer,nObj](const Queued& o) {
+      return o.layer == layer && dd->isBetterEQ(o.node->getBound(),nObj) && dd->dominates(o.node,n);
+   };
+   if (_dd->hasDominanceKey()) {
+      if (!_earlyStop)
+         return _dix.findDominator(_dd->dominanceKey(n),isDom).node;
+      // an entry of the layer worse than n ends the scan (see `retractDominated`)
+      return _dix.findDominator(_dd->dominanceKey(n),isDom,[dd = _dd,layer,nObj](const Queued& o) {
+         return o.layer == layer && dd->isBetter(nObj,o.node->getBound());
+      }).node;
+   }
+   const auto& q = _qn.at(layer);
+   for(auto i = q.rbegin();i != q.rend();i++) // the most recent dominator
+      if (*i && isDom(Queued { *i,layer,0 }))
+         return *i;
+   return nullptr;
+}
+
+void WidthBounded::retractDominated(ANode::Ptr n,unsigned layer,double nObj)
+{
+   if (!_dd->hasDominanceKey())
+      return;
+   _gone.clear();
+   const auto isDom = [this,n,layer,nObj](const Queued& o) {
+      if (o.layer == layer && _dd->isBetterEQ(nObj,o.node->getBound()) && _dd->dominates(n,o.node))
+         _gone.push_back(o);
+   };
+   if (!_earlyStop)
+      _dix.forDominated(_dd->dominanceKey(n),isDom);
+   else // closest rank first, up to the first node of the layer whose bound rules it out (see `setEarlyStop`)
+      _dix.forDominated(_dd->dominanceKey(n),isDom,[dd = _dd,layer,nObj](const Queued& o) {
+         return o.layer == layer && dd->isBetter(o.node->getBound(),nObj);
+      });
+   for(const auto& o : _gone) { // o leaves the layer, its incoming arcs now reach n.
+      auto d = o.node;
+      _dix.remove(_dd->dominanceKey(d),[d](const Queued& e) { return e.node == d;});
+      _qn.retract(o.layer,o.at);
+      for(auto pi = d->beginPar();pi != d->endPar();pi++) {
+         Edge::Ptr e = *pi;
+         e->_to = n;
+         n->addArc(e);
+      }
+      d->clearParents();
+      if (_dd->isBetter(d->getBound(),n->getBound())) {
+         n->setBound(d->getBound());
+         n->setBest(d->_best);
+      }
+      _dd->_an.remove(d);
+   }
 }
 
 void WidthBounded::tighten(ANode::Ptr nd) noexcept
@@ -372,8 +370,7 @@ void WidthBounded::tighten(ANode::Ptr nd) noexcept
       auto ep = e->_from->getBound() + e->_obj;
       if (_dd->isBetter(ep,cur)) {
          cur = ep;
-         nd->_optLabels = e->_from->_optLabels;
-         nd->_optLabels.push_back(e->_lbl);
+         nd->setBest(e);
       }
    }  
    nd->setBound(cur);
@@ -393,69 +390,54 @@ void Restricted::truncate(NDArray& layer)
    layer.eraseSuffix(from);
 }
 
-ANode::Ptr Restricted::checkDominance(CQueue<ANode::Ptr>& qn,ANode::Ptr n,double nObj)
-{
-   auto rv = qn.foldl([theDD = _dd,nObj,n](ANode::Ptr acc,ANode::Ptr o) {
-      const bool objDom = theDD->isBetterEQ(o->getBound(),nObj);
-      const bool stateDom = theDD->dominates(o,n);
-      return (objDom && stateDom) ? o : acc;
-   },nullptr);
-   return rv;
-}
-
-
 void Restricted::compute(Bounds& bnds)
 {
    const bool hasDom = _dd->hasDominance();
    _dd->_exact = true;
    auto root = _dd->init();
    _dd->target();
-   CQueue<ANode::Ptr> qn(32);
+   _qn.clear();
    root->setLayer(0);
-   qn.enQueue(root);
-   while (!qn.empty()) { 
-      auto& lk = pullLayer(qn); // We have in lk the queue content for layer cL
-      for(auto p : lk) { // loop over layer lk. p is a "parent" node.
-         auto remLabels = _dd->getLabels(p,DDRestricted);
-         for(auto l : remLabels) {
-            auto child = _dd->transition(bnds,p,l); // we get back a new node, or an already existing one.
-            if (child) {
-               bool newNode = child->nbParents()==0; // is this a newly created node?
-               auto theCost = _dd->cost(p,l);
-               auto ep = p->getBound() + theCost;
-               if (hasDom && newNode) {
-                  auto dominator = checkDominance(qn,child,ep);
-                  if (dominator) {
-                     _dd->_an.pop_back();
-                     child = dominator;
-                     newNode = false;
-                  }
-               }               
-               Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
-               e->_obj = theCost;
-               _dd->addArc(e); // connect to new node
-               if (_dd->isBetter(ep,child->getBound())) {
-                  child->setBound(ep);
-                  child->_optLabels = p->_optLabels;
-                  child->_optLabels.push_back(e->_lbl);
-               }
-               child->setLayer(std::max(child->getLayer(),p->getLayer()+1));
-               if (!_dd->eqSink(child)) {
-                  if (newNode) {
-                     qn.enQueue(child);
-                     auto nbNode = estimate(qn);
-                     //std::cout << "#NODES: " << nbNode << "\n";
-                     if (nbNode > _mxw - 1) {
-                        //std::cout << "JUMP..." << nbNode << '/' << _mxw << "\n";
-                        _dd->_exact = false;
-                        goto next;
-                     }
-                  }
-               }
-            }            
+   _qn.push(root,0);
+   const auto arc = [this,hasDom](ANode::Ptr p,int l,ANode::Ptr child,double theCost) {
+      bool newNode = child->nbParents()==0; // is this a newly created node?
+      auto ep = p->getBound() + theCost;
+      if (hasDom && newNode) {
+         auto dominator = checkDominance(child,p->getLayer() + 1,ep);
+         if (dominator) {
+            _dd->_an.pop_back();
+            child = dominator;
+            newNode = false;
+         } else retractDominated(child,p->getLayer() + 1,ep);
+      }               
+      Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
+      e->_obj = theCost;
+      _dd->addArc(e); // connect to new node
+      if (_dd->isBetter(ep,child->getBound())) {
+         child->setBound(ep);
+         child->setBest(e);
+      }
+      child->setLayer(std::max(child->getLayer(),p->getLayer()+1));
+      if (!_dd->eqSink(child)) {
+         if (newNode) {
+            enQueue(child);
+            auto nbNode = _qn.size(child->getLayer());
+            //std::cout << "#NODES: " << nbNode << "\n";
+            if (nbNode > _mxw - 1) {
+               //std::cout << "JUMP..." << nbNode << '/' << _mxw << "\n";
+               _dd->_exact = false;
+               return false; // skip the rest of the layer
+            }
          }
-      }         
-   next:;
+      }
+      return true;
+   };
+   while (!_qn.empty()) {
+      auto& lk = pullLayer();
+      mergeSort(lk.data(),lk.size(),[dd = _dd](const ANode::Ptr& a,const ANode::Ptr& b) { // sort better to worse
+         return dd->isBetter(a->getBound(),b->getBound());
+      });
+      _dd->expandLayer(bnds,lk,DDRestricted,arc);
    }
    //_dd->computeBest(getName());
    tighten(_dd->_trg);
@@ -466,24 +448,26 @@ void Restricted::compute(Bounds& bnds)
 
 void Relaxed::transferArcs(ANode::Ptr donor,ANode::Ptr receiver)
 {
+   // Only the receiving end of an arc changes: the other end keeps the arc in place (and its index).
    for(auto ei = donor->beginPar(); ei != donor->endPar();ei++) {
       auto ep = *ei;
       ep->_to = receiver;
-      _dd->addArc(ep);
+      receiver->addArc(ep);
    }
+   donor->clearParents();
    assert(donor->nbChildren()==0);
    for(auto ei = donor->beginKids(); ei != donor->endKids();ei++) {
       auto ep = *ei;
       ep->_from = receiver;
-      _dd->addArc(ep);
+      receiver->addArc(ep);
    }
-   donor->disconnect();
+   donor->clearKids();
 }
 
-NDAction Relaxed::mergePair(ANode::Ptr mNode,ANode::Ptr toMerge[2])
+NDAction Relaxed::mergePair(ANode::Ptr mNode,std::span<const ANode::Ptr> toMerge)
 {
-   assert(toMerge[0] != nullptr && toMerge[1] != nullptr);
-   // Neither toMerge[0], nor toMerge[1] are in the layer
+   assert(toMerge.size() >= 2);
+   // None of toMerge[i] are in the layer
    // mNode could be
    // 1. A brand new node NOT in the layer
    // 2. A node already in the layer but not in toMerge
@@ -495,8 +479,7 @@ NDAction Relaxed::mergePair(ANode::Ptr mNode,ANode::Ptr toMerge[2])
    mNode->setExact(false); // surely inexact now 
    _dd->_exact = false;    // DD inexact as well
    bool addIt = false;
-   for(auto i = 0; i < 2;i++) {
-      auto d = toMerge[i];            
+   for(auto d : toMerge) {
       if (d != mNode) { // skip in case the node itself is the merged one
          transferArcs(d,mNode);
          _dd->_an.remove(d);
@@ -507,22 +490,56 @@ NDAction Relaxed::mergePair(ANode::Ptr mNode,ANode::Ptr toMerge[2])
                      : NDAction::Delay };
 }
 
-ANode::Ptr Relaxed::mergeOne(auto& layer,auto& skip)
+ANode::Ptr Relaxed::mergeOne(std::vector<ANode::Ptr>& layer,std::size_t& h,std::size_t& nb)
 {   
-   auto i = layer.begin();
-   auto n1 = *i;
+   while (layer[h] == nullptr) ++h;  // layer[h] is the front, merged nodes leave a nullptr behind
+   auto n1 = layer[h];
    if (n1->nbChildren() > 0) {
-      i = layer.erase(i);
-      skip.push_back(n1);
+      ++h;--nb;
+      _skip.push_back(n1);
       return nullptr;
    }
    assert(n1->nbChildren()==0);
-   ANode::Ptr toMerge[2] = {n1,nullptr};
    ANode::Ptr mNode = nullptr;
-   auto j = i;
-   for(++j;j != layer.end();++j) {
-      auto n2 = *j;
-      if (n2->nbChildren() || n1->getLayer() != n2->getLayer()) {
+   MergePart* part = nullptr; // with a merge key, the partners of n1 are the later slots of its part
+   std::size_t at = 0;
+   if (!_mkey.empty()) {
+      part = &_parts[_mkey[h]];
+      while (part->slots[part->head] != h) ++part->head;
+      at = part->head;
+   }
+   const auto next = [&](std::size_t& j) {
+      if (part == nullptr) return ++j < layer.size();
+      if (++at == part->slots.size()) return false;
+      j = part->slots[at];
+      return true;
+   };
+   _group.clear();
+   _gslot.clear();
+   _group.push_back(n1);
+   const auto partner = [n1](ANode::Ptr n2) {
+      return n2 != nullptr && n2->nbChildren() == 0 && n1->getLayer() == n2->getLayer();
+   };
+   std::size_t j = h;
+   if (_dd->hasNaryMerge()) { // n1 and the next partners, as many as needed to reach the width
+      const auto need = _skip.size() + nb - _mxw;
+      while (_group.size() <= need && next(j))
+         if (partner(layer[j])) {
+            _group.push_back(layer[j]);
+            _gslot.push_back(j);
+         }
+      if (_group.size() > 1)
+         mNode = _dd->merge(std::span<const ANode::Ptr>(_group));
+      if (mNode == nullptr) { // refused: pairwise merge instead
+         _group.resize(1);
+         _gslot.clear();
+         j = h;
+         if (part) at = part->head;
+      }
+   }
+   while (mNode == nullptr && next(j)) {
+      auto n2 = layer[j];
+      if (!partner(n2)) {
          // std::cout << "n2 has children? "  << n2->nbChildren() << "\n";
          // std::cout << "layers? "  << n1->getLayer() << " " << n2->getLayer() << "\n";
          continue;
@@ -533,7 +550,7 @@ ANode::Ptr Relaxed::mergeOne(auto& layer,auto& skip)
       if (mNode) {
          if (mNode->nbChildren() > 0) {
             std::cout << "\tmerged result has children... no dice... "
-                      << toMerge[0]->getLayer() << " "
+                      << n1->getLayer() << " "
                       << n2->getLayer() << " "
                       << " --> " << mNode->getLayer() << " ** ";
             _dd->printNode(std::cout,mNode);
@@ -542,145 +559,92 @@ ANode::Ptr Relaxed::mergeOne(auto& layer,auto& skip)
             //continue;
          }
          //assert(mNode->nbChildren()==0);         
-         toMerge[1] = n2;
+         _group.push_back(n2);
+         _gslot.push_back(j);
          break;
       }
    }
-   if (toMerge[1]) {
-      assert(mNode != nullptr);
-      i = layer.erase(i);
-      j = layer.erase(j);
-      NDAction act = mergePair(mNode,toMerge);
+   if (mNode) {
+      ++h;
+      for(auto s : _gslot)
+         layer[s] = nullptr;
+      nb -= _group.size();
+      NDAction act = mergePair(mNode,_group);
       switch(act.act) {
          case NDAction::Delay:
             return act.node;
          case NDAction::InFront:
-            layer.push_front(act.node);
+            layer[--h] = act.node; // reuses the slot of n1
+            ++nb;
+            if (part) {
+               const auto k = _dd->mergeKey(act.node);
+               if (k != _mkey[h]) { // the slot moves to the front of the part of k
+                  ++part->head;
+                  _mkey[h] = k;
+                  auto& kp = _parts[k];
+                  if (kp.head > 0) kp.slots[--kp.head] = h;
+                  else kp.slots.insert(kp.slots.begin(),h);
+               }
+            }
             return nullptr;
          case NDAction::Noop:
             return nullptr;
       }
    } else {
-      assert(mNode == nullptr);
-      i = layer.erase(i);
-      skip.push_back(n1);
+      ++h;--nb;
+      _skip.push_back(n1);
    }
    return nullptr;
 }
 
 
-template <typename Fun> void Relaxed::mergeLayer(auto& layer,Fun f)
+template <typename Fun> void Relaxed::mergeLayer(std::vector<ANode::Ptr>& layer,Fun f)
 {
    // std::cout << "MERGING " << layer.size() << " TARGET width:" << _mxw << "\n";
-   // for(auto n : layer) {
-   //    std::cout << "\t";
-   //    //_dd->printNode(std::cout,n);
-   //    std::cout << n->getId() << " " << n->getBound() << " " << n->getBackwardBound();
-   //    std::cout << " LAYER:" << n->getLayer() << "\n";
-   // }
-   std::list<ANode::Ptr> skip;
-   while (skip.size() + layer.size() > _mxw && layer.size() > 0) {
-      auto dn = mergeOne(layer,skip); // skipped nodes are not willing to  merge with anything.
+   _skip.clear();
+   std::size_t h = 0,nb = layer.size(); // the live nodes are the non-null entries of layer[h..]
+   _mkey.clear();
+   if (_dd->hasMergeKey() && nb > _mxw) { // partition the slots by merge key
+      _parts.clear();
+      _mkey.resize(nb);
+      for(auto i=0u;i < nb;i++) {
+         auto& p = _parts[_mkey[i] = _dd->mergeKey(layer[i])];
+         p.slots.push_back(i);
+      }
+   }
+   while (_skip.size() + nb > _mxw && nb > 0) {
+      auto dn = mergeOne(layer,h,nb); // skipped nodes are not willing to  merge with anything.
       if (dn) f(dn); // delayed node saw a change in layer. Back in the overall queue via f
    }
-   layer.splice(layer.begin(),std::move(skip)); // put the skipped guys back in
-
+   auto to = layer.begin();
+   for(auto i = layer.begin() + h;i != layer.end();i++)
+      if (*i) *to++ = *i;
+   layer.erase(to,layer.end());
+   layer.insert(layer.begin(),_skip.begin(),_skip.end()); // put the skipped guys back in
    // std::cout << "AFTER MERGING " << layer.size() << " TARGET width:" << _mxw << "\n";
-   // for(auto n : layer) {
-   //    std::cout << "\t";
-   //    //_dd->printNode(std::cout,n);
-   //    std::cout << n->getId() << " " << n->getBound() << " " << n->getBackwardBound();
-   //    std::cout << " LAYER:" << n->getLayer() << "\n";
-   // }   
 }
 
 void Relaxed::adjustBounds(ANode::Ptr nd)
-{   
-   for(auto ki = nd->beginKids();ki != nd->endKids();ki++) {
-      Edge::Ptr e = *ki; // edge
-      auto end = e->_to;
-      auto ep  = nd->_bound + e->_obj;
-      if (_dd->isBetter(ep,end->_bound)) {
-         end->_bound = ep;
-         end->_optLabels = nd->_optLabels;
-         end->_optLabels.push_back(e->_lbl);
-         adjustBounds(end);
+{
+   _adj.clear();
+   _adj.push_back(nd);
+   while (!_adj.empty()) { // worklist rather than recursion: deep diagrams would overflow the stack
+      auto n = _adj.back();
+      _adj.pop_back();
+      for(auto ki = n->beginKids();ki != n->endKids();ki++) {
+         Edge::Ptr e = *ki; // edge
+         auto end = e->_to;
+         auto ep  = n->_bound + e->_obj;
+         if (_dd->isBetter(ep,end->_bound)) {
+            end->_bound = ep;
+            end->setBest(e);
+            _adj.push_back(end);
+         }
       }
    }
 } 
    
 
-class LQueue {
-   std::list<ANode::Ptr> _next;
-   std::list<ANode::Ptr> _rest;
-   Relaxed&              _dd;
-   void insertInNext(ANode::Ptr n) {
-      _next.push_front(n);
-   }
-public:
-   LQueue(Relaxed& dd) : _next(),_rest(),_dd(dd) {}
-   void enQueue(ANode::Ptr n) noexcept {
-      if (_next.size() == 0)
-         _next.push_back(n);
-      else {
-         if (_next.front()->getLayer() == n->getLayer()) {
-            insertInNext(n);
-                if (0 && _next.size() > 2 *  _dd.getWidth()) { // eager is not a clear gain.
-               _next.sort([dd = _dd.theDD()](const ANode::Ptr& a,const ANode::Ptr& b) {
-                  return !dd->isBetter(a->getBound(),b->getBound());
-               });
-               _dd.mergeLayer(_next,[this](ANode::Ptr dn)  {
-                  _rest.push_back(dn);
-               });
-            }
-         } else 
-            _rest.push_back(n);         
-      }
-   }
-   ANode::Ptr checkDominance(ANode::Ptr n,double nObj) {
-      AbstractDD* theDD = _dd.theDD();
-      for(const auto& o : _next) {
-         const bool objDom = theDD->isBetterEQ(o->getBound(),nObj);
-         const bool stateDom = theDD->dominates(o,n);
-         if (objDom && stateDom) 
-            return o;
-      }
-      return nullptr;
-   }
-   bool empty() const noexcept {
-      return size() == 0;
-   }
-   std::size_t size() const noexcept {
-      return _next.size() + _rest.size();
-   }
-   std::list<ANode::Ptr> pullLayer() noexcept {
-      std::list<ANode::Ptr> retVal = std::move(_next);
-
-      //sort and collapse the layer via merging when the layer is pulled.
-      retVal.sort([dd = _dd.theDD()](const ANode::Ptr& a,const ANode::Ptr& b) {
-         return !dd->isBetter(a->getBound(),b->getBound());
-      });
-      _dd.mergeLayer(retVal,[this](ANode::Ptr dn)  {
-         // std::cout << "Putting nd is rest: ";
-         // _dd.theDD()->printNode(std::cout,dn);
-         // std::cout << "\n";
-         // char ch; std::cin >> ch;         
-         _dd.adjustBounds(dn);         
-         //_rest.push_back(dn);
-      });
-
-      auto layer = (_rest.size() > 0) ? _rest.front()->getLayer() : -1;
-      for(auto i = _rest.begin(); i != _rest.end();) {
-         if ((*i)->getLayer() != layer)            
-            break;
-         //std::cout << "adding: " << (*i)->getId() << "\n" << std::flush;
-         _next.push_back(*i);
-         i = _rest.erase(i);
-      }
-      return retVal;
-   }
-};
-
 void Relaxed::compute(Bounds& bnds)
 {
    const bool hasDom = _dd->hasDominance();
@@ -688,49 +652,67 @@ void Relaxed::compute(Bounds& bnds)
    _dd->_exact = true;
    auto root = _dd->init();
    _dd->target();
-   LQueue qn(*this);
+   _qn.clear();
    root->setLayer(0);
-   qn.enQueue(root);
-   while (!qn.empty()) {
-      auto lk = qn.pullLayer();
-      //std::cout << lk.size() << " " << std::flush;
-      for(auto p : lk) { // loop over layer lk. p is a "parent" node.
-         auto remLabels = _dd->getLabels(p,DDRelaxed);
-         for(auto l : remLabels) {
-            auto child = _dd->transition(bnds,p,l); // we get back a new node, or an already existing one.
-            if (child) {
-               bool newNode = child->nbParents()==0; // is this a newly created node?
-               auto theCost = _dd->cost(p,l);
-               auto ep = p->getBound() + theCost;
-               if (hasDom && newNode) {
-                  auto dominator = qn.checkDominance(child,ep);
-                  if (dominator) {
-                     // ANode::Ptr justAdded = _dd->_an.back();
-                     // assert(justAdded == child);
-                     //std::cout << "relaxed -> dominated!\n"; 
-                     _dd->_an.pop_back();
-                     child = dominator;
-                     newNode = false;
-                     //continue;
-                  }
-               }               
-               Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
-               e->_obj = theCost;
-               _dd->addArc(e); // connect to new node
-               if (_dd->isBetter(ep,child->getBound())) {
-                  child->setBound(ep);
-                  child->_optLabels = p->_optLabels;
-                  child->_optLabels.push_back(e->_lbl);
-               }
-               child->setLayer(std::max(child->getLayer(),p->getLayer()+1));               
-               if (!_dd->eqSink(child)) {
-                  if (newNode)
-                     qn.enQueue(child);
-               }
-            }            
-         }
+   _qn.push(root,0);
+   const bool lel = _cst == CSLastExactLayer;
+   bool allExact = lel; // every layer pulled so far is exact
+   _lel.clear();
+   _skips = false;
+   unsigned sinkFrom = std::numeric_limits<unsigned>::max(); // shallowest layer with an arc into the sink
+   const auto arc = [this,hasDom,lel,&sinkFrom](ANode::Ptr p,int l,ANode::Ptr child,double theCost) {
+      bool newNode = child->nbParents()==0; // is this a newly created node?
+      auto ep = p->getBound() + theCost;
+      if (hasDom && newNode) {
+         auto dominator = checkDominance(child,p->getLayer() + 1,ep);
+         if (dominator) {
+            // ANode::Ptr justAdded = _dd->_an.back();
+            // assert(justAdded == child);
+            //std::cout << "relaxed -> dominated!\n"; 
+            _dd->_an.pop_back();
+            child = dominator;
+            newNode = false;
+            //continue;
+         } else retractDominated(child,p->getLayer() + 1,ep);
+      }               
+      Edge::Ptr e = new (_dd->_mem) Edge(p,child,l);
+      e->_obj = theCost;
+      _dd->addArc(e); // connect to new node
+      if (_dd->isBetter(ep,child->getBound())) {
+         child->setBound(ep);
+         child->setBest(e);
+      }
+      const bool isSink = _dd->eqSink(child);
+      if (lel && !newNode && !isSink && child->getLayer() != p->getLayer() + 1)
+         _skips = true;
+      if (isSink)
+         sinkFrom = std::min(sinkFrom,p->getLayer());
+      child->setLayer(std::max(child->getLayer(),p->getLayer()+1));               
+      if (!isSink) {
+         if (newNode)
+            enQueue(child);
+      }
+      return true;
+   };
+   while (!_qn.empty()) {
+      auto& lk = pullLayer();
+      // sort worse to better (equal nodes in queue order) and collapse the layer via merging.
+      std::stable_sort(lk.begin(),lk.end(),[dd = _dd](const ANode::Ptr& a,const ANode::Ptr& b) {
+         return dd->isBetter(b->getBound(),a->getBound());
+      });
+      mergeLayer(lk,[this](ANode::Ptr dn)  {
+         adjustBounds(dn);
+      });
+      if (allExact) {
+         allExact = std::all_of(lk.begin(),lk.end(),[](ANode::Ptr n) { return n->isExact();});
+         if (allExact)
+            _lel.assign(lk.begin(),lk.end());
       }
+      //std::cout << lk.size() << " " << std::flush;
+      _dd->expandLayer(bnds,lk,DDRelaxed,arc);
    }
+   if (lel && !_lel.empty() && sinkFrom < _lel.front()->getLayer())
+      _skips = true; // a path ends above the last exact layer
    // auto incr = _dd->currentOpt();
    // _dd->computeBest(getName());
    // auto full = _dd->currentOpt();
@@ -740,53 +722,77 @@ void Relaxed::compute(Bounds& bnds)
    //_dd->display();
 }
 
-std::vector<ANode::Ptr> Relaxed::computeCutSet()
+std::vector<ANode::Ptr> Relaxed::computeCutSet(Bounds& bnds)
 {
    //_dd->display();
    //char ch;std::cin>>ch;
+   if (_cst == CSLastExactLayer && !_skips)
+      return _lel;
+   const double primal = bnds.getPrimal();
    std::vector<ANode::Ptr> cs = {};
-   auto mark = _dd->_mem->mark();
-   CQueue<ANode::Ptr> qn(32);
-   auto idSZ = _dd->getLastId() + 1;
-   bool* inQueue = new (_dd->_mem) bool[idSZ];
-   memset(inQueue,0,sizeof(bool)*idSZ);
-   qn.enQueue(_dd->_root);
-   inQueue[_dd->_root->getId()] = true;
-   while (qn.size() > 0) {
-      auto cur = qn.deQueue();
-      if (cur->isExact()) {
+   auto& fz = _dd->_fz;
+   if (!fz.frozen())
+      fz.freeze(_dd->_an,_dd->getLastId() + 1);
+   const auto trg = fz.index(_dd->_trg);
+   _inQueue.assign(fz.size(),false);
+   _bfs.clear();
+   _bfs.push_back(fz.index(_dd->_root));
+   _inQueue[_bfs.back()] = true;
+   for(std::size_t h = 0;h < _bfs.size();h++) {
+      const auto cur = _bfs[h];
+      if (fz.exact(cur)) {
+         if (!_dd->isBetter(fz.bound(cur) + fz.bbound(cur),primal))
+            continue; // no improving path through cur
          bool akExact = true;
-         for(auto ki = cur->beginKids(); akExact && ki != cur->endKids();ki++) {
-            if ((*ki)->_to->getId() == _dd->_trg->getId()) continue;
-            akExact = (*ki)->_to->isExact();
-            // if (akExact == false) {
-            //    std::cout << "SINK:";
-            //    _dd->printNode(std::cout,_dd->_trg);
-            //    std::cout << "\n";
-            //    std::cout << "LABEL:" << (*ki)->_lbl << "\n";
-            //    std::cout << "NOT all kids exact because of:";
-            //    _dd->printNode(std::cout,(*ki)->_to);
-            //    std::cout << "\n";
-            //    std::cout << "Will add:";
-            //    _dd->printNode(std::cout,cur);              
-            //    std::cout << "\n";
-            //    std::cout << ((*ki)->_to->getId()) << " "  << _dd->_trg->getId() << "\n";
-            //    std::cout << "KID is sink? " << _dd->eqSink((*ki)->_to) << "\n";
-            //    std::cout << "KID is ==sink? " << _dd->eq((*ki)->_to,_dd->_trg) << "\n";
-            // }
-         }
+         for(auto a = fz.outBegin(cur);akExact && a != fz.outEnd(cur);a++)
+            akExact = fz.dst(a) == trg || fz.exact(fz.dst(a));
          if (akExact) {
-            for(auto ki = cur->beginKids(); akExact && ki != cur->endKids();ki++) {
-               if (!inQueue[(*ki)->_to->getId()]
-                   && ((*ki)->_to->getId() != _dd->_trg->getId())
-                   ) {
-                  qn.enQueue((*ki)->_to);
-                  inQueue[(*ki)->_to->getId()] = true;
+            for(auto a = fz.outBegin(cur);a != fz.outEnd(cur);a++) {
+               const auto k = fz.dst(a);
+               if (!_inQueue[k] && k != trg) {
+                  _bfs.push_back(k);
+                  _inQueue[k] = true;
                }
             }
-         } else cs.push_back(cur);
+         } else cs.push_back(fz.node(cur));
       }
    }
-   _dd->_mem->clear(mark);
+   return cs;
+}
+
+// ----------------------------------------------------------------------
+// Refined DD Strategy
+
+void Refined::compute(Bounds& bnds)
+{
+   Relaxed::compute(bnds);
+   _skips = true; // the last exact layer is stale once refined
+   for(auto k = 0u;k < 8 && !_dd->isExact() && _dd->refine(bnds,_mxw);k++) {
+      _dd->_exact = std::all_of(_dd->_an.begin(),_dd->_an.end(),[](ANode::Ptr n) { return n->isExact();});
+      _dd->computeBest(getName());
+      _dd->computeBestBackward(getName());
+   }
+}
+
+std::vector<ANode::Ptr> Refined::computeCutSet(Bounds& bnds)
+{
+   auto cs = Relaxed::computeCutSet(bnds);
+   auto trg = _dd->_trg;
+   if (trg->isExact())
+      return cs;
+   const double primal = bnds.getPrimal();
+   auto& fz = _dd->_fz;
+   const auto t = fz.index(trg);
+   for(auto pi = trg->beginPar();pi != trg->endPar();pi++) {
+      const auto i = fz.index((*pi)->_from);
+      if (!_inQueue[i] || !fz.exact(i) || !_dd->isBetter(fz.bound(i) + fz.bbound(i),primal))
+         continue;
+      _inQueue[i] = false; // once per node
+      bool akExact = true;   // otherwise it is in the cutset already
+      for(auto a = fz.outBegin(i);akExact && a != fz.outEnd(i);a++)
+         akExact = fz.dst(a) == t || fz.exact(fz.dst(a));
+      if (akExact)
+         cs.push_back((*pi)->_from);
+   }
    return cs;
 }
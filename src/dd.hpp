@@ -10,21 +10,36 @@
 #include <optional>
 #include <set>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <span>
+#include <numeric>
 #include "lighthash.hpp"
 #include "util.hpp"
 #include "msort.hpp"
 #include "pool.hpp"
+#include "domindex.hpp"
+#include "cache.hpp"
+#include "taskpool.hpp"
+#include "frontier.hpp"
+#include "frozen.hpp"
+#include "spill.hpp"
 
 class Strategy;
 class AbstractDD;
 
 typedef std::function<void(const std::vector<int>&)> SolutionCB;
+typedef std::list<SolutionCB>::iterator SolutionHandle;
 
 class Bounds {
-   double _primal,_g,_dual;
+   std::atomic<double> _primal;
+   double _g,_dual;
    bool _primalSet,_dualSet;
    std::vector<int> _inc;
    std::list<SolutionCB> _checker;
+   std::mutex _mtx; // serializes updates when several searches share the bounds
 public:
    Bounds() : _primalSet(false),_dualSet(false) {}
    Bounds(SolutionCB checker) : _primalSet(false),_dualSet(false)  {
@@ -32,9 +47,11 @@ public:
    }  
    Bounds(std::shared_ptr<AbstractDD> dd);
    void attach(std::shared_ptr<AbstractDD> dd);
-   void setPrimal(double p)         { _primal = p;_primalSet = true;}
+   void lock()                      { _mtx.lock();}
+   void unlock()                    { _mtx.unlock();}
+   void setPrimal(double p)         { _primal.store(p,std::memory_order_release);_primalSet = true;}
    void setDual(double g,double h)  { _g = g;_dual = h;_dualSet = true;}
-   double getPrimal() const         { return _primal;}
+   double getPrimal() const         { return _primal.load(std::memory_order_acquire);}
    bool hasPrimal() const noexcept  { return _primalSet;}
    double getDual() const           { return _dual;}
    double getG() const              { return _g;}
@@ -46,11 +63,21 @@ public:
       for(const auto& f : _checker)
          f(_inc);
    }
-   void onSolution(SolutionCB cb) {
-      _checker.push_back(cb);
+   const std::vector<int>& getIncumbent() const noexcept { return _inc;}
+   /**
+    * Registers a callback invoked on every new incumbent. Callbacks capturing locals of a search
+    * must be removed (`offSolution`) before the search returns: the bounds may outlive it.
+    */
+   SolutionHandle onSolution(SolutionCB cb) {
+      std::lock_guard<std::mutex> lock(_mtx);
+      return _checker.insert(_checker.end(),cb);
+   }
+   void offSolution(SolutionHandle h) {
+      std::lock_guard<std::mutex> lock(_mtx);
+      _checker.erase(h);
    }
    friend std::ostream& operator<<(std::ostream& os,const Bounds& b) {
-      return os << "<P:" << b._primal << "," << " D:" << b._dual << ", INC:" << b._inc << ">";
+      return os << "<P:" << b.getPrimal() << "," << " D:" << b._dual << ", INC:" << b._inc << ">";
    }
 };
 
@@ -58,17 +85,50 @@ class AbstractNodeAllocator {
 protected:
    LPool::Ptr _base;
 public:
+   typedef std::shared_ptr<AbstractNodeAllocator> Ptr;
    AbstractNodeAllocator(LPool::Ptr base) : _base(base) {}
-   virtual ~AbstractNodeAllocator() {}
+   virtual ~AbstractNodeAllocator() { delete _base->get();delete _base;}
+   /**
+    * Copies `src` unless its state was already cloned with a bound at least as good.
+    * @return the copy or nullptr when `src` is redundant.
+    */
    virtual ANode::Ptr cloneNode(ANode::Ptr src) = 0;
-   virtual void release(ANode::Ptr src) = 0;
+   virtual Ptr share() const = 0;                   // a new allocator (own pool) sharing this transposition table
+   virtual ANode::Ptr copyNode(ANode::Ptr src) = 0; // unconditional copy (no transposition check)
+   virtual bool superseded(ANode::Ptr n) = 0;       // true if n's state was cloned later with a better bound
+   virtual void release(ANode::Ptr src) = 0;        // src (and its label buffer) gets recycled by the next copy
+   /**
+    * Binary (de)serialization of a node: state (through the model serializer), bounds and label prefix.
+    * Only available when the model provides a state serializer (see `DD::setStateSerializer`).
+    */
+   virtual bool canSerialize() const noexcept = 0;
+   virtual void writeNode(std::ostream& os,ANode::Ptr n) const = 0;
+   virtual ANode::Ptr readNode(std::istream& is) = 0;
+   virtual void setCapacity(std::size_t nbEntries) = 0; // cap on the transposition table (0 = unbounded)
+   virtual std::size_t nbEntries() const = 0;
    Pool::Ptr get() const noexcept { return _base->get();}
-   typedef std::shared_ptr<AbstractNodeAllocator> Ptr;   
+   std::size_t liveBytes() const noexcept { return _base->liveBytes();} // storage of the nodes in use
+   std::size_t liveNodes() const noexcept { return _base->liveNodes();} // nodes in use
 };
 
 enum LocalContext { BBCtx, DDCtx, DDInit };
 enum DDContext { DDRelaxed,DDRestricted,DDExact};
 
+/**
+ * An arc out of a state: its label, the state it leads to and its cost (see `DD::setExpander`).
+ */
+template <typename ST> struct Successor {
+   int    label;
+   ST     state;
+   double cost;
+};
+
+/**
+ * Wires the arc `parent --label--> child` of cost `cost` during a layer expansion.
+ * Returns false to skip the rest of the layer.
+ */
+typedef std::function<bool(ANode::Ptr parent,int label,ANode::Ptr child,double cost)> ArcFun;
+
 class AbstractDD {
 protected:
    Pool::Ptr _mem;
@@ -77,16 +137,25 @@ protected:
    GNSet   _labels;
    ANList      _an;
    bool _exact;
+   std::size_t _streamPeak; // most states held at once by the last streaming compile
    PoolMark _baseline;
    void addArc(Edge::Ptr e);
+   void removeArc(Edge::Ptr e);
    friend class Strategy;
    friend class Exact;
    friend class Restricted;
    friend class Relaxed;
+   friend class Refined;
    friend class WidthBounded;
    Strategy* _strat;
+   TaskPool::Ptr _tp; // parallel layer expansion (nullptr = sequential)
+   virtual void expandSerial(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc) = 0;
+   virtual void expandParallel(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc) = 0;
+   virtual void computeStreaming(Bounds& bnds,bool spill) = 0;
+   virtual bool refine(Bounds& bnds,unsigned mxw) = 0;
    virtual bool eqSink(ANode::Ptr s) const = 0;
    virtual bool eq(ANode::Ptr f,ANode::Ptr s) const = 0;
+   FrozenDD _fz; // the last compiled diagram, frozen by the first pass after a change (bounds or cutset)
    void computeBest(const std::string m);
    void computeBestBackward(const std::string m);
    void saveGraph(std::ostream& os,std::string gLabel);
@@ -98,8 +167,9 @@ public:
    virtual void reset() = 0;
    virtual ANode::Ptr init() = 0;
    virtual ANode::Ptr target() = 0;
-   virtual ANode::Ptr transition(Bounds& bnds,ANode::Ptr src,int label) = 0;
+   virtual ANode::Ptr transition(Bounds& bnds,ANode::Ptr src,int label,double& cost) = 0; // cost of the arc when there is a child
    virtual ANode::Ptr merge(const ANode::Ptr first,const ANode::Ptr snd) = 0;
+   virtual ANode::Ptr merge(std::span<const ANode::Ptr> group) = 0;
    virtual double cost(ANode::Ptr src,int label) = 0;
    virtual double local(ANode::Ptr src,enum LocalContext lc) = 0;
    virtual ANode::Ptr duplicate(const ANode::Ptr src) = 0;
@@ -111,6 +181,12 @@ public:
    virtual bool hasLocal() const noexcept = 0;
    virtual bool hasDominance() const noexcept = 0;
    virtual bool dominates(ANode::Ptr f,ANode::Ptr s) = 0;
+   virtual bool hasDominanceKey() const noexcept = 0;
+   virtual DomKey dominanceKey(ANode::Ptr n) const = 0;
+   virtual bool hasMergeKey() const noexcept = 0;
+   virtual std::size_t mergeKey(ANode::Ptr n) const = 0;
+   virtual bool hasNaryMerge() const noexcept = 0;
+   virtual bool hasSerializer() const noexcept = 0;
    virtual void update(Bounds& bnds) const = 0;
    virtual void printNode(std::ostream& os,ANode::Ptr n) const = 0;
    virtual GNSet getLabels(ANode::Ptr src,DDContext) const = 0;
@@ -120,40 +196,79 @@ public:
    bool apply(ANode::Ptr from,Bounds& bnds);
    std::vector<int> incumbent();
    void compute(Bounds& bnds);
-   std::vector<ANode::Ptr> computeCutSet();
+   std::vector<ANode::Ptr> computeCutSet(Bounds& bnds);
+   /**
+    * Generates the children of every node of `layer` and hands each arc to `arc`, in the order of
+    * a sequential scan (parents in order, labels in increasing order). The successors of a parent are
+    * generated in one batch (see `DD::setExpander`) before its children are created. With a task pool,
+    * the model functions (labels, transition, cost, local bound) run concurrently for all the parents and
+    * the nodes are then created and wired sequentially, so the diagram does not depend on the pool.
+    * The model functions must then be reentrant.
+    */
+   void expandLayer(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc);
+   void setTaskPool(TaskPool::Ptr tp) { _tp = tp;}
    void print(std::ostream& os,std::string gLabel);
    void setStrategy(Strategy* s);
    void display();
    bool isExact() const { return _exact;}
+   /**
+    * Most states held at once by the last streaming compile (see `Exact::setStreaming`): two consecutive
+    * layers at most.
+    */
+   std::size_t streamPeak() const noexcept { return _streamPeak;}
+   /**
+    * Path records of the last streaming compile: bytes they take on the heap and number of records in
+    * segment files (see `Exact::setSpill`).
+    */
+   virtual std::size_t streamHeapBytes() const noexcept = 0;
+   virtual std::size_t streamDiskRecords() const noexcept = 0;
    virtual AbstractDD::Ptr duplicate() = 0;
    virtual void makeInitFrom(ANode::Ptr src) {}
+   virtual void printCaches(std::ostream& os) const {} // statistics of the enabled model caches
 };
 
 class Strategy {
 protected:
    AbstractDD* _dd;
+   Frontier    _qn; // nodes left to expand (reused by every compilation)
    friend class AbstractDD;
 public:
    Strategy() : _dd(nullptr) {}
+   virtual ~Strategy() {}
    AbstractDD* theDD() const noexcept { return _dd;}
    virtual const std::string getName() const = 0;
    virtual void compute(Bounds&) {}
-   virtual std::vector<ANode::Ptr> computeCutSet() { return std::vector<ANode::Ptr> {};}
+   virtual std::vector<ANode::Ptr> computeCutSet(Bounds&) { return std::vector<ANode::Ptr> {};}
    virtual bool primal() const { return false;}
    virtual bool dual() const { return false;}
 };
 
 class Exact:public Strategy {
+   bool _streaming;
+   bool _spill;
 public:
-   Exact() : Strategy() {}
+   Exact() : Strategy(),_streaming(false),_spill(false) {}
    const std::string getName() const { return "Exact";}
+   /**
+    * Streaming mode: only the layer being expanded and the next one are held (as plain states with their
+    * bound), plus one (parent,label) record per state for the optimal path. No node or arc of the diagram
+    * is kept, so memory is bounded by the widest layer rather than the whole diagram. States are merged
+    * within a layer only. Only the root and the sink (with the optimum and its labels) are nodes afterwards.
+    * This covers the forward pass of an exact compile only: the relaxed diagrams (backward bounds, cutset
+    * walk) still keep all their layers in memory.
+    */
+   void setStreaming(bool s) noexcept { _streaming = s;}
+   /**
+    * Streaming mode only: the path records of the completed layers go to memory-mapped segment files
+    * (see `MappedLog`) instead of the heap. The exact compile then keeps only the two live layers resident;
+    * the relaxed diagrams of a `BAndB` are unaffected.
+    */
+   void setSpill(bool s) noexcept { _spill = s;}
    void compute(Bounds&);
    bool primal() const { return true;}
    bool dual() const { return true;}
 };
 
-template <class T> class CQueue;
-
 class NDArray {
    ANode::Ptr*   _tab;
    std::size_t    _mx;
@@ -274,14 +389,31 @@ public:
 
 class WidthBounded :public Strategy {
 protected:
+   struct Queued { // a node of the frontier, as seen by the dominance index
+      ANode::Ptr  node;
+      unsigned    layer;
+      std::size_t at;
+   };
    unsigned _mxw;
-   NDArray  _nda;
-   NDArray& pullLayer(CQueue<ANode::Ptr>& q);
-   std::size_t estimate(CQueue<ANode::Ptr>& q);
+   bool     _earlyStop; // bounded in-layer dominance scans (see `setEarlyStop`)
+   DomIndex<Queued> _dix; // nodes queued for the next layer, by dominance key (when the model has one)
+   std::vector<ANode::Ptr>& pullLayer();
+   void enQueue(ANode::Ptr n);
+   ANode::Ptr checkDominance(ANode::Ptr n,unsigned layer,double nObj);
+   void retractDominated(ANode::Ptr n,unsigned layer,double nObj);
+   std::vector<Queued> _gone;
 public:
-   WidthBounded(const unsigned mxw) : Strategy(),_mxw(mxw) {}
+   WidthBounded(const unsigned mxw) : Strategy(),_mxw(mxw),_earlyStop(false) {}
    void setWidth(unsigned  mxw) { _mxw = mxw;}
    unsigned getWidth() const  { return _mxw;}
+   /**
+    * Heuristic bound on the in-layer dominance scans of models with a dominance key. Since dominated nodes
+    * leave the layer, the queued nodes of a bucket tend to form an antichain: the larger the rank, the worse
+    * the bound. With `on`, a scan stops at the first node of the layer whose bound rules it out. It may then
+    * miss dominance relations (wider layers), never adds a wrong one. Off by default: the scans visit every
+    * entry of the bucket on the right side of the rank.
+    */
+   void setEarlyStop(bool on) { _earlyStop = on;}
    void tighten(ANode::Ptr nd) noexcept;
 };
 
@@ -292,10 +424,20 @@ public:
    const std::string getName() const { return "Restricted";}
    void compute(Bounds& );
    bool primal() const { return true;}
-   ANode::Ptr checkDominance(CQueue<ANode::Ptr>& qn,ANode::Ptr n,double nObj);
 };
 
 
+/**
+ * Cutset of a relaxed DD (the exact nodes queued by the B&B).
+ *  - CSFrontier: exact nodes with an inexact child, found by a traversal from the root. Exact nodes
+ *    whose forward plus backward bound cannot beat the primal are left out, and so are the exact
+ *    nodes reachable only through them.
+ *  - CSLastExactLayer: the deepest layer such that it and every layer above it are exact. It is
+ *    recorded during the compilation. When an arc skips a layer or a path reaches the sink above
+ *    it, the layer is not a cutset and the frontier is used instead.
+ */
+enum CutSetType { CSFrontier, CSLastExactLayer };
+
 struct NDAction {
    enum Action { Delay,InFront,Noop};
    ANode::Ptr node;
@@ -303,19 +445,63 @@ struct NDAction {
 };
 
 class Relaxed :public WidthBounded {
+protected:
+   CutSetType              _cst;
+   std::vector<ANode::Ptr> _lel;   // last exact layer of the last compilation
+   bool                    _skips; // some path of the last compilation does not cross `_lel`
+   std::vector<FrozenDD::Idx> _bfs;  // `computeCutSet` queue and marks
+   std::vector<char>          _inQueue;
+private:
+   std::vector<ANode::Ptr> _skip;  // nodes of the layer being merged that merge with nothing
+   struct MergePart {               // slots of the layer sharing a merge key, in layer order
+      std::vector<std::size_t> slots;
+      std::size_t              head;  // slots before head are gone
+   };
+   std::unordered_map<std::size_t,MergePart> _parts; // by merge key (see `AbstractDD::mergeKey`)
+   std::vector<std::size_t> _mkey;                   // merge key of every slot of the layer
+   std::vector<ANode::Ptr>  _group;  // nodes merged by the current step, the front first
+   std::vector<std::size_t> _gslot;  // their slots in the layer, but for the front
+   std::vector<ANode::Ptr>  _adj;    // worklist of `adjustBounds`
    void transferArcs(ANode::Ptr donor,ANode::Ptr receiver);
 public:
-   Relaxed(const unsigned mxw) : WidthBounded(mxw) {}
+   Relaxed(const unsigned mxw) : WidthBounded(mxw),_cst(CSFrontier),_skips(false) {}
    const std::string getName() const { return "Relaxed";}
+   void setCutSetType(CutSetType t) { _cst = t;}
+   /**
+    * @return true when `computeCutSet` returns the last exact layer of the last compilation.
+    */
+   bool lastExactCut() const noexcept { return _cst == CSLastExactLayer && !_skips;}
    void compute(Bounds&);
-   std::vector<ANode::Ptr> computeCutSet();
+   std::vector<ANode::Ptr> computeCutSet(Bounds& bnds);
    bool dual() const { return true;}
-   NDAction mergePair(ANode::Ptr mNode,ANode::Ptr toMerge[2]);
-   ANode::Ptr mergeOne(auto& layer,auto& final);
-   template <typename Fun> void mergeLayer(auto& layer,Fun f);
+   NDAction mergePair(ANode::Ptr mNode,std::span<const ANode::Ptr> toMerge);
+   ANode::Ptr mergeOne(std::vector<ANode::Ptr>& layer,std::size_t& head,std::size_t& nb);
+   template <typename Fun> void mergeLayer(std::vector<ANode::Ptr>& layer,Fun f);
    void adjustBounds(ANode::Ptr nd);
 };
 
+/**
+ * Relaxed DD tightened by incremental refinement. The top-down relaxation of width `getWidth()` is
+ * compiled first and then refined by passes, until a pass changes nothing (at most 8 passes). A pass goes
+ * layer by layer from the top and re-evaluates the arcs entering a layer from their (refined) sources:
+ * arcs that became infeasible or cannot lead to a solution better than the primal bound are filtered out
+ * and the others are grouped by the state they lead to. Merged nodes are split, the one on the best path
+ * first, by peeling off their best groups of arcs into nodes of their own while the layer holds fewer than
+ * `getWidth()` nodes. A merged node that lost groups is re-merged from the remaining ones. A split node
+ * inherits the outgoing arcs of the merged node that remain feasible from its tighter state.
+ * Transitions and merges should be monotone (a tighter state has a subset of the successors, each one
+ * tighter), so refining never weakens the top-down bound.
+ * The cutset is always the frontier. Filtered arcs can leave exact paths into an inexact sink, so the exact
+ * nodes ending such paths join the cutset.
+ */
+class Refined :public Relaxed {
+public:
+   Refined(const unsigned mxw) : Relaxed(mxw) {}
+   const std::string getName() const { return "Refined";}
+   void compute(Bounds&);
+   std::vector<ANode::Ptr> computeCutSet(Bounds& bnds);
+};
+
 template<typename T>
 concept Comparable = requires(const T& a,const T& b)
 {
@@ -348,40 +534,102 @@ struct Maximize {
 };
 
 
-template <typename ST> requires Printable<ST> && Hashable<ST>
+/**
+ * @brief Node allocator for the B&B open list.
+ * It carries a transposition table mapping every state cloned so far to the best forward bound
+ * it was reached with. A node whose state was already cloned with a bound at least as good is
+ * redundant: the subproblem below that state is (or was) explored from the better prefix.
+ * The table is bounded (CLOCK eviction). Evicting an entry only forgets a transposition.
+ * Allocators made with `share` use the same (striped, thread-safe) table, so the B&B workers all
+ * see the transpositions found by the others.
+ */
+template <typename ST,class Compare> requires Printable<ST> && Hashable<ST>
 class DDNodeAllocator :public AbstractNodeAllocator {
-   LHashtable<ST> _nmap;
+   typedef CClockCache<ST,double> TTable;
+   std::shared_ptr<TTable>                      _tt;
+   std::function<void(std::ostream&,const ST&)> _sWrite;
+   std::function<ST(std::istream&)>              _sRead;
+   template <typename... Args> Node<ST>* make(Args&&... args) { // a new node on the pool
+      const auto u0 = _base->get()->usage();
+      auto nn = new (_base->get()) Node<ST>(_base->get(),std::forward<Args>(args)...);
+      const auto u1 = _base->get()->usage();
+      _base->made(u1 > u0 ? u1 - u0 : 0);
+      return nn;
+   }
+   Node<ST>* claim(ST&& s) {
+      auto reuse = _base->claimNode();
+      if (reuse) {
+         Node<ST>* nn = static_cast<Node<ST>*>(reuse.get());
+         nn->resetWith(std::move(s));
+         return nn;
+      } else return make(std::move(s),_base->grabId(),true);
+   }
 public:
-   DDNodeAllocator(LPool::Ptr pool) : AbstractNodeAllocator(pool),_nmap(pool->get(),200000) {}
-   ANode::Ptr cloneNode(ANode::Ptr src) override {      
+   DDNodeAllocator(LPool::Ptr pool,
+                   std::function<void(std::ostream&,const ST&)> sw = nullptr,
+                   std::function<ST(std::istream&)> sr = nullptr)
+      : AbstractNodeAllocator(pool),_tt(std::make_shared<TTable>(1 << 20)),_sWrite(sw),_sRead(sr) {}
+   AbstractNodeAllocator::Ptr share() const override {
+      auto na = std::make_shared<DDNodeAllocator<ST,Compare>>(new LPool(new Pool),_sWrite,_sRead);
+      na->_tt = _tt;
+      return na;
+   }
+   ANode::Ptr cloneNode(ANode::Ptr src) override {
       auto sp = static_cast<const Node<ST>*>(src.get());
-      Node<ST>* nn = new (_base->get()) Node<ST>(_base->get(),_base->grabId(),*sp);
-      return nn;
-      /*
-      //temporarily out. Something not correct here. [ldm]
-      Node<ST>* at = nullptr;
-      auto inMap = _nmap.getLoc(sp->get(),at);
-      if (!inMap) {
-         auto reuse = _base->claimNode();
-         if (reuse) {
-            Node<ST>* nn = static_cast<Node<ST>*>(reuse.get());
-            nn->resetWith(sp);
-            _nmap.safeInsertAt(inMap,nn);
-            return nn;
-         } else {
-            Node<ST>* nn = new (_base->get()) Node<ST>(_base->get(),_base->grabId(),*sp);
-            _nmap.safeInsertAt(inMap,nn);
-            return nn;
-         }
-      } else {
-         //std::cout << "Already added node to B&B...." << "\n";         
-         return nullptr;
-         }
-      */
+      const bool fresh = _tt->update(sp->get(),[sp](auto& tt) {
+         auto at = tt.find(sp->get());
+         if (at) {
+            if (!Compare{}.better(sp->getBound(),*at))
+               return false;
+            *at = sp->getBound();
+         } else tt.insert(sp->get(),sp->getBound());
+         return true;
+      });
+      return fresh ? copyNode(src) : nullptr;
+   }
+   ANode::Ptr copyNode(ANode::Ptr src) override {
+      auto sp = static_cast<const Node<ST>*>(src.get());
+      auto reuse = _base->claimNode();
+      if (reuse) {
+         Node<ST>* nn = static_cast<Node<ST>*>(reuse.get());
+         nn->resetWith(sp);
+         return nn;
+      }
+      return make(_base->grabId(),*sp);
+   }
+   bool superseded(ANode::Ptr n) override {
+      auto np = static_cast<const Node<ST>*>(n.get());
+      return _tt->update(np->get(),[np](auto& tt) {
+         auto at = tt.find(np->get());
+         return at && Compare{}.better(*at,np->getBound());
+      });
    }
    void release(ANode::Ptr src) override {
-      //_base->release(src);
+      _base->release(src);
+   }
+   bool canSerialize() const noexcept override { return _sWrite && _sRead;}
+   void writeNode(std::ostream& os,ANode::Ptr n) const override {
+      auto np = static_cast<const Node<ST>*>(n.get());
+      _sWrite(os,np->get());
+      writeBin(os,np->getBound());
+      writeBin(os,np->getBackwardBound());
+      const auto lbls = np->optLabels();
+      writeBin(os,(unsigned)lbls.size());
+      for(auto l : lbls)
+         writeBin(os,l);
    }
+   ANode::Ptr readNode(std::istream& is) override {
+      Node<ST>* nn = claim(_sRead(is));
+      nn->setBound(readBin<double>(is));
+      nn->setBackwardBound(readBin<double>(is));
+      std::vector<int> lbls(readBin<unsigned>(is));
+      for(auto& l : lbls)
+         l = readBin<int>(is);
+      nn->setIncumbent(lbls.begin(),lbls.end());
+      return nn;
+   }
+   void setCapacity(std::size_t nbEntries) override { _tt->setCapacity(nbEntries);}
+   std::size_t nbEntries() const override           { return _tt->size();}
 };
 
 
@@ -408,9 +656,98 @@ private:
    SMF _smf;
    EQSink _eqs;
    std::function<double(const ST&,LocalContext)> _local;
+   struct LocalCache { // memoized `_local` values, shared by the duplicates of the DD (see `setLocalCache`)
+      std::mutex                           mtx;
+      ClockCache<ST,double,std::hash<ST>,Equal> tab;
+   };
+   std::shared_ptr<LocalCache> _lcache;
+   struct TransKey {     // a (state,label) pair of the successor cache (see `setSuccessorCache`)
+      ST  state;
+      int label;
+   };
+   struct TransProbe {   // the same pair, without copying the state (lookups)
+      const ST* state;
+      int       label;
+   };
+   struct TransHash {
+      using is_transparent = void;
+      std::size_t operator()(const TransKey& k) const   { return std::rotl(std::hash<ST>{}(k.state),7) ^ std::hash<int>{}(k.label);}
+      std::size_t operator()(const TransProbe& k) const { return std::rotl(std::hash<ST>{}(*k.state),7) ^ std::hash<int>{}(k.label);}
+   };
+   struct TransEq {
+      using is_transparent = void;
+      bool operator()(const TransKey& a,const TransKey& b) const   { return a.label == b.label && Equal{}(a.state,b.state);}
+      bool operator()(const TransProbe& a,const TransKey& b) const { return a.label == b.label && Equal{}(*a.state,b.state);}
+      bool operator()(const TransKey& a,const TransProbe& b) const { return a.label == b.label && Equal{}(a.state,*b.state);}
+   };
+   struct TransVal {
+      std::optional<ST> state; // nullopt when the label is infeasible
+      double            cost;
+   };
+   struct TransCache {
+      std::mutex                                        mtx;
+      ClockCache<TransKey,TransVal,TransHash,TransEq>   tab;
+   };
+   std::shared_ptr<TransCache> _tcache;
    SDOM _sdom;
+   std::function<DomKey(const ST&)> _domKey;
+   std::function<std::size_t(const ST&)> _mergeKey;
+   std::function<std::optional<ST>(std::span<const ST* const>)> _nmf;
+   std::vector<const ST*> _mst; // states of the group given to `_nmf`
+   std::function<void(const ST&,DDContext,std::vector<Successor<ST>>&)> _exp;
+   std::function<void(std::ostream&,const ST&)> _sWrite;
+   std::function<ST(std::istream&)>              _sRead;
    LHashtable<ST> _nmap;
    unsigned _ndId;
+   std::vector<std::vector<Successor<ST>>> _succ; // successors computed ahead of their nodes, one buffer per parent
+   std::vector<std::vector<double>>        _dual; // and their local bounds. Both are reused across layers.
+   struct Slot { // a state of a layer in streaming mode (see `Exact::setStreaming`)
+      ST            state;
+      double        bound;
+      std::uint64_t rec;   // its path record (the record of its best parent until the layer is complete)
+      int           label; // label of its best incoming arc
+   };
+   struct PathRec {
+      std::uint64_t from;  // record of the parent, `NoRec` for the root
+      int           label;
+   };
+   static constexpr std::uint64_t NoRec = UINT64_MAX;
+   struct SlotHash {
+      const std::vector<Slot>* tab;
+      std::size_t operator()(std::uint32_t i) const { return std::hash<ST>{}((*tab)[i].state);}
+   };
+   struct SlotEq {
+      const std::vector<Slot>* tab;
+      bool operator()(std::uint32_t i,std::uint32_t j) const { return Equal{}((*tab)[i].state,(*tab)[j].state);}
+   };
+   std::vector<Slot>    _scur,_snext;
+   std::vector<PathRec> _paths;
+   std::unique_ptr<MappedLog<PathRec>> _spilled; // `_paths` on disk (see `Exact::setSpill`)
+   struct RClass { // arcs entering a node of the layer being refined that lead to the same state
+      ST                     state;
+      double                 val;   // best path through these arcs
+      bool                   exact; // every source is exact
+      std::vector<Edge::Ptr> arcs;
+   };
+   struct RNode { // a node of the layer being refined and its classes
+      ANode::Ptr    node;
+      std::uint32_t from,to;
+      bool          cut;   // some of its arcs were dropped
+   };
+   struct RClassHash {
+      const std::vector<RClass>* tab;
+      std::size_t operator()(std::uint32_t i) const { return std::hash<ST>{}((*tab)[i].state);}
+   };
+   struct RClassEq {
+      const std::vector<RClass>* tab;
+      bool operator()(std::uint32_t i,std::uint32_t j) const { return Equal{}((*tab)[i].state,(*tab)[j].state);}
+   };
+   std::vector<std::vector<ANode::Ptr>> _rl; // nodes by layer (see `refine`)
+   std::vector<RClass>    _rc;
+   std::vector<RNode>     _rn;
+   std::vector<std::uint32_t> _rord;
+   std::vector<RClass*>   _rleft;
+   std::vector<Edge::Ptr> _rarcs;
    std::function<ANode::Ptr()> _initClosure;
    bool eq(ANode::Ptr f,ANode::Ptr s) const noexcept {
       auto fp = static_cast<const Node<ST>*>(f.get());
@@ -431,18 +768,65 @@ private:
       return Compare{}.better(obj1,obj2) ? obj1 : obj2;
    }
    bool hasLocal() const noexcept       { return _local != nullptr;}
+   /**
+    * Transition and arc cost of `label` from `s`. `cost` is only set when the successor exists.
+    */
+   std::optional<ST> successor(const ST& s,int label,double& cost) {
+      if (!_tcache) {
+         auto vs = _stf(s,label);
+         if (vs.has_value())
+            cost = _stc(s,label);
+         return vs;
+      }
+      {
+         std::lock_guard<std::mutex> lock(_tcache->mtx);
+         auto at = _tcache->tab.find(TransProbe { &s, label });
+         if (at) {
+            cost = at->cost;
+            return at->state;
+         }
+      }
+      auto vs = _stf(s,label);
+      if (vs.has_value())
+         cost = _stc(s,label);
+      std::lock_guard<std::mutex> lock(_tcache->mtx);
+      _tcache->tab.insert(TransKey { s, label },TransVal { vs, vs.has_value() ? cost : 0.0 });
+      return vs;
+   }
+   double localBound(const ST& s,LocalContext lc) {
+      if (!_lcache)
+         return _local(s,lc);
+      {
+         std::lock_guard<std::mutex> lock(_lcache->mtx);
+         auto at = _lcache->tab.find(s);
+         if (at)
+            return *at;
+      }
+      const double v = _local(s,lc); // outside the lock: concurrent layers compute their bounds in parallel
+      std::lock_guard<std::mutex> lock(_lcache->mtx);
+      _lcache->tab.insert(s,v);
+      return v;
+   }
    bool hasDominance() const noexcept   { return _sdom != nullptr;}
+   bool hasDominanceKey() const noexcept { return _sdom != nullptr && _domKey != nullptr;}
+   bool hasMergeKey() const noexcept { return _mergeKey != nullptr;}
+   bool hasNaryMerge() const noexcept { return _nmf != nullptr;}
+   bool hasSerializer() const noexcept { return _sWrite != nullptr && _sRead != nullptr;}
    double initialBest() const noexcept  { return Compare{}.bestValue();}
    double initialWorst() const noexcept { return Compare{}.worstValue();}
    void update(Bounds& bnds) const {
+      std::lock_guard<Bounds> lock(bnds);
+      if (!isBetter(_trg->getBound(),bnds.getPrimal()))
+         return; // a concurrent search already reported something at least as good
+      const auto lbls = _trg->optLabels();
       if (_strat->primal())  {
          bnds.setPrimal(DD::better(_trg->getBound(),bnds.getPrimal()));
-         bnds.setIncumbent(_trg->beginOptLabels(),_trg->endOptLabels());
+         bnds.setIncumbent(lbls.begin(),lbls.end());
          std::cout <<  std::setprecision(6) << "P TIGHTEN: " << bnds << "\n";
       }
       else if (_strat->dual() && _exact) {
          bnds.setPrimal(DD::better(_trg->getBound(),bnds.getPrimal()));
-         bnds.setIncumbent(_trg->beginOptLabels(),_trg->endOptLabels());
+         bnds.setIncumbent(lbls.begin(),lbls.end());
          std::cout <<  std::setprecision(6) << "D TIGHTEN: " << bnds << "\n";
       }
    }
@@ -483,21 +867,31 @@ private:
    }
    GNSet getLabels(ANode::Ptr src,DDContext c) const {
       auto op = static_cast<const Node<ST>*>(src.get());
-      auto valSet = _lgf(op->get(),c);
+      return getLabels(op->get(),c);
+   }
+   GNSet getLabels(const ST& s,DDContext c) const {
+      auto valSet = _lgf(s,c);
       if constexpr (std::is_same<decltype(valSet),GNSet>::value) {
          return valSet;
-      } else {
+      } else if constexpr (std::is_constructible<GNSet,decltype(valSet)>::value) {
          return GNSet(valSet);
+      } else { // any other forward range of labels
+         int ub = -1;
+         for(auto l : valSet)
+            ub = std::max(ub,(int)l);
+         GNSet rv(ub + 1);
+         for(auto l : valSet)
+            rv.insert(l);
+         return rv;
       }
    }
-   ANode::Ptr transition(Bounds& bnds,ANode::Ptr src,int label) {
+   ANode::Ptr transition(Bounds& bnds,ANode::Ptr src,int label,double& cVal) {
       auto op = static_cast<const Node<ST>*>(src.get());
-      auto vs = _stf(op->get(),label);     
+      auto vs = successor(op->get(),label,cVal);
       if (vs.has_value()) {
          ANode::Ptr rv;
          if (_local) {
-            auto cVal = _stc(op->get(),label);
-            auto dual = _local(vs.value(),DDCtx);
+            auto dual = localBound(vs.value(),DDCtx);
             auto sCost = src->getBound() + cVal + dual;
             if (!isBetter(sCost,bnds.getPrimal())) {
                return nullptr;
@@ -511,17 +905,362 @@ private:
          return rv;
       } else return nullptr;
    }
+   /**
+    * Appends the feasible successors of `s` to `out`, in increasing label order, and their local bounds to
+    * `duals` (when there is a local bound). Goes through the expansion hook when there is one.
+    */
+   void successors(const ST& s,DDContext c,std::vector<Successor<ST>>& out,std::vector<double>& duals) {
+      out.clear();
+      duals.clear();
+      if (_exp)
+         _exp(s,c,out);
+      else {
+         const auto gen = [this,&s,&out](int l) {
+            double cVal;
+            auto vs = successor(s,l,cVal);
+            if (vs.has_value())
+               out.push_back(Successor<ST> { l,std::move(vs.value()),cVal });
+         };
+         auto lbls = _lgf(s,c);
+         if constexpr (std::is_same<decltype(lbls),Range>::value) {
+            for(auto l : lbls.ascending())
+               gen(l);
+         } else {
+            for(auto l : lbls)
+               gen(l);
+         }
+      }
+      if (_local)
+         for(const auto& x : out)
+            duals.push_back(localBound(x.state,DDCtx));
+   }
+   /**
+    * Creates the children of `p` from its successors (same filtering as `transition`) and hands the arcs to `arc`.
+    * @return false when `arc` stopped the expansion.
+    */
+   bool wire(Bounds& bnds,ANode::Ptr p,std::vector<Successor<ST>>& out,const std::vector<double>& duals,const ArcFun& arc) {
+      for(auto k = 0u;k < out.size();k++) {
+         auto& s = out[k];
+         ANode::Ptr rv;
+         if (_local) {
+            if (!isBetter(p->getBound() + s.cost + duals[k],bnds.getPrimal()))
+               continue;
+            rv = makeNode(std::move(s.state),p->isExact());
+            if (!isBetter(duals[k],rv->getBackwardBound()))
+               rv->setBackwardBound(duals[k]);
+         } else rv = makeNode(std::move(s.state),p->isExact());
+         if (!arc(p,s.label,rv,s.cost))
+            return false;
+      }
+      return true;
+   }
+   void expandSerial(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc) {
+      if (_succ.empty()) {
+         _succ.resize(1);
+         _dual.resize(1);
+      }
+      for(auto p : layer) {
+         successors(static_cast<const Node<ST>*>(p.get())->get(),c,_succ[0],_dual[0]);
+         if (!wire(bnds,p,_succ[0],_dual[0],arc))
+            return;
+      }
+   }
+   void expandParallel(Bounds& bnds,const std::vector<ANode::Ptr>& layer,DDContext c,const ArcFun& arc) {
+      if (_succ.size() < layer.size()) {
+         _succ.resize(layer.size());
+         _dual.resize(layer.size());
+      }
+      _tp->forEach(layer.size(),[this,&layer,c](std::size_t i) { // model calls only: no shared writes
+         successors(static_cast<const Node<ST>*>(layer[i].get())->get(),c,_succ[i],_dual[i]);
+      });
+      for(auto i = 0u;i < layer.size();i++)
+         if (!wire(bnds,layer[i],_succ[i],_dual[i],arc))
+            return;
+   }
+   void computeStreaming(Bounds& bnds,bool spill) {
+      if (spill) {
+         std::vector<PathRec>().swap(_paths); // no copy of the records left on the heap
+         if (!_spilled)
+            _spilled = std::make_unique<MappedLog<PathRec>>();
+         stream(bnds,*_spilled);
+      } else {
+         _spilled.reset();
+         stream(bnds,_paths);
+      }
+   }
+   std::size_t streamHeapBytes() const noexcept   { return _paths.capacity() * sizeof(PathRec);}
+   std::size_t streamDiskRecords() const noexcept { return _spilled ? _spilled->size() : 0;}
+   /**
+    * Forward pass of the streaming exact compile (see `Exact::setStreaming`): two live layers plus the path
+    * records in `paths`. There is no backward pass and no cutset here; those belong to the relaxed diagrams,
+    * which are built layer by layer in memory.
+    */
+   template <class Log> void stream(Bounds& bnds,Log& paths) {
+      _exact = true;
+      auto root = static_cast<const Node<ST>*>(init().get());
+      bool reached = false;
+      double tb = initialBest();        // best path to the sink
+      PathRec tRec { NoRec, 0 };
+      _streamPeak = 0;
+      paths.clear();
+      _scur.clear();
+      _scur.push_back(Slot { root->get(), root->getBound(), NoRec, 0 });
+      if (_succ.empty()) {
+         _succ.resize(1);
+         _dual.resize(1);
+      }
+      std::unordered_set<std::uint32_t,SlotHash,SlotEq> index(64,SlotHash { &_snext },SlotEq { &_snext });
+      while (!_scur.empty()) {
+         _snext.clear();
+         index.clear();
+         for(auto& p : _scur) {
+            successors(p.state,DDExact,_succ[0],_dual[0]);
+            for(auto k = 0u;k < _succ[0].size();k++) {
+               auto& [l,vs,cVal] = _succ[0][k];
+               const double ep = p.bound + cVal;
+               if (_local && !isBetter(ep + _dual[0][k],bnds.getPrimal()))
+                  continue; // same filter as `transition`
+               if (_eqs(vs)) {
+                  if (!reached || isBetter(ep,tb)) {
+                     tb = ep;
+                     tRec = PathRec { p.rec, l };
+                     reached = true;
+                  }
+                  continue;
+               }
+               _snext.push_back(Slot { std::move(vs), ep, p.rec, l });
+               auto [at,fresh] = index.insert(_snext.size() - 1);
+               if (!fresh) { // known state: keep the best incoming arc
+                  auto& o = _snext[*at];
+                  if (isBetter(ep,o.bound)) {
+                     o.bound = ep;
+                     o.rec   = p.rec;
+                     o.label = l;
+                  }
+                  _snext.pop_back();
+               }
+            }
+         }
+         for(auto& n : _snext) { // the layer is complete: record the best paths
+            paths.push_back(PathRec { n.rec, n.label });
+            n.rec = paths.size() - 1;
+         }
+         _streamPeak = std::max(_streamPeak,_scur.size() + _snext.size());
+         std::swap(_scur,_snext);
+      }
+      _snext.clear();
+      target();
+      if (reached) {
+         std::vector<int> lbls { tRec.label };
+         for(auto r = tRec.from;r != NoRec;r = paths[r].from)
+            lbls.push_back(paths[r].label);
+         auto pre = _root->optLabels();
+         lbls.insert(lbls.end(),pre.rbegin(),pre.rend());
+         std::reverse(lbls.begin(),lbls.end());
+         _trg->setBound(tb);
+         _trg->setIncumbent(lbls);
+      }
+   }
+   void kill(ANode::Ptr n) {
+      n->disconnect();
+      _an.remove(n);
+   }
+   /**
+    * Moves the arcs of class `c` from `u` to the node of state `c.state` (a node of layer `j`).
+    * A new node also gets the outgoing arcs of `u` that are feasible from its state.
+    * @return false when that state belongs to another node of the diagram (`u` included) or to a node
+    * of layer `j` whose bound would increase.
+    */
+   bool peel(Bounds& bnds,ANode::Ptr u,RClass& c,unsigned j,unsigned& width) {
+      auto ex = hasNode(c.state);
+      if (ex && (ex == u || ex == _root || ex == _trg ||
+                 (ex->nbParents() > 0 ? ex->getLayer() != j : ex->nbChildren() > 0)))
+         return false; // a node of another layer, or one left without parents that is not removed yet
+      if (ex && ex->nbParents() > 0 && isBetter(c.val,ex->getBound()))
+         return false; // its outgoing arcs were filtered with a lower bound
+      auto x = makeNode(std::move(c.state),c.exact);
+      const bool fresh = x->nbParents() == 0;
+      if (fresh)
+         x->setExact(c.exact); // possibly a leftover node of an earlier pass
+      for(auto e : c.arcs) {
+         removeArc(e);
+         e->_to = x;
+         addArc(e);
+      }
+      if (!fresh) {
+         x->setBound(better(x->getBound(),c.val));
+         return true;
+      }
+      ++width;
+      x->setLayer(j);
+      x->setBound(c.val);
+      x->setBackwardBound(u->getBackwardBound());
+      const auto& xs = static_cast<const Node<ST>*>(x.get())->get();
+      const auto lbls = getLabels(xs,DDRelaxed);
+      for(auto ki = u->beginKids();ki != u->endKids();ki++) {
+         Edge::Ptr f = *ki;
+         if (!lbls.contains(f->_lbl))
+            continue;
+         double cVal;
+         auto vs = successor(xs,f->_lbl,cVal);
+         if (!vs.has_value())
+            continue;
+         if (_local && !isBetter(c.val + cVal + localBound(vs.value(),DDCtx),bnds.getPrimal()))
+            continue; // same filter as `transition`
+         Edge::Ptr e = new (_mem) Edge(x,f->_to,f->_lbl);
+         e->_obj = cVal;
+         addArc(e);
+      }
+      return true;
+   }
+   void exactIfOwn(ANode::Ptr u,const RClass& c) { // u is only reached through the arcs of c
+      auto us = static_cast<const Node<ST>*>(u.get());
+      if (c.exact && u->nbParents() == c.arcs.size() && Equal{}(us->get(),c.state))
+         u->setExact(true);
+   }
+   /**
+    * Groups the arcs entering `u` by the state they lead to (in `_rc`). Drops the infeasible arcs and those
+    * that cannot lie on a path better than the primal bound.
+    * @return true when an arc was dropped.
+    */
+   bool classify(Bounds& bnds,ANode::Ptr u,std::unordered_set<std::uint32_t,RClassHash,RClassEq>& index) {
+      index.clear();
+      _rarcs.assign(u->beginPar(),u->endPar());
+      double cur = initialBest();
+      bool cut = false;
+      for(auto e : _rarcs) {
+         auto ps = static_cast<const Node<ST>*>(e->_from.get());
+         double cVal;
+         auto vs = successor(ps->get(),e->_lbl,cVal);
+         const double ep = ps->getBound() + cVal;
+         if (!vs.has_value() || !isBetter(ep + u->getBackwardBound(),bnds.getPrimal())) {
+            removeArc(e);
+            cut = true;
+            continue;
+         }
+         e->_obj = cVal;
+         cur = better(cur,ep);
+         _rc.push_back(RClass { std::move(vs.value()), ep, ps->isExact(), { e } });
+         auto [at,fresh] = index.insert(_rc.size() - 1);
+         if (!fresh) {
+            auto& o = _rc[*at];
+            o.val   = better(o.val,ep);
+            o.exact = o.exact && ps->isExact();
+            o.arcs.push_back(e);
+            _rc.pop_back();
+         }
+      }
+      u->setBound(cur);
+      return cut;
+   }
+   /**
+    * One refinement pass over the diagram, from the top.
+    * @return true when the diagram changed.
+    */
+   bool refine(Bounds& bnds,unsigned mxw) {
+      _fz.thaw(); // the diagram changes
+      unsigned nbl = 0;
+      for(auto n : _an)
+         nbl = std::max(nbl,n->getLayer() + 1);
+      _rl.resize(std::max<std::size_t>(_rl.size(),nbl));
+      for(auto& l : _rl)
+         l.clear();
+      for(auto n : _an)
+         if (n != _root && n != _trg)
+            _rl[n->getLayer()].push_back(n);
+      std::unordered_set<std::uint32_t,RClassHash,RClassEq> index(16,RClassHash { &_rc },RClassEq { &_rc });
+      bool changed = false;
+      for(auto j = 1u;j < nbl;j++) {
+         _rc.clear();
+         _rn.clear();
+         unsigned width = 0;
+         for(auto u : _rl[j]) {
+            const auto from = (std::uint32_t)_rc.size();
+            const bool cut = classify(bnds,u,index);
+            changed = changed || cut;
+            if (u->nbParents() == 0) {
+               kill(u);
+               continue;
+            }
+            ++width;
+            if (!u->isExact())
+               _rn.push_back(RNode { u, from, (std::uint32_t)_rc.size(), cut });
+         }
+         std::stable_sort(_rn.begin(),_rn.end(),[this](const RNode& a,const RNode& b) { // best path first
+            return isBetter(a.node->getBound() + a.node->getBackwardBound(),b.node->getBound() + b.node->getBackwardBound());
+         });
+         for(auto& r : _rn) {
+            auto u = r.node;
+            _rord.resize(r.to - r.from); // classes, best first (states are not moved around)
+            std::iota(_rord.begin(),_rord.end(),r.from);
+            std::stable_sort(_rord.begin(),_rord.end(),[this](std::uint32_t a,std::uint32_t b) {
+               return isBetter(_rc[a].val,_rc[b].val);
+            });
+            auto& left = _rleft;
+            left.clear();
+            for(auto k = 0u;k < _rord.size();k++)
+               if (left.size() + (_rord.size() - k) < 2 || width >= mxw || !peel(bnds,u,_rc[_rord[k]],j,width))
+                  left.push_back(&_rc[_rord[k]]);
+            if (left.size() == _rord.size() && !r.cut) { // u relaxes the same states as before
+               if (left.size() == 1)
+                  exactIfOwn(u,*left[0]);
+               continue;
+            }
+            changed = true;
+            if (left.size() == 1) { // u is down to a single state
+               if (!peel(bnds,u,*left[0],j,width))
+                  exactIfOwn(u,*left[0]);
+            }
+            else { // re-merge what is left of u (a subset of the states it relaxed)
+               RClass rest { left[0]->state, initialBest(), false, {} };
+               bool merged = true;
+               for(auto k = 1u;k < left.size() && merged;k++) {
+                  auto ms = _smf(rest.state,left[k]->state);
+                  merged = ms.has_value();
+                  if (merged)
+                     rest.state = std::move(*ms);
+               }
+               if (merged) {
+                  for(auto c : left) {
+                     rest.val = better(rest.val,c->val);
+                     rest.arcs.insert(rest.arcs.end(),c->arcs.begin(),c->arcs.end());
+                  }
+                  peel(bnds,u,rest,j,width);
+               }
+            }
+            if (u->nbParents() == 0) {
+               kill(u);
+               --width;
+            } else {
+               double cur = initialBest();
+               for(auto pi = u->beginPar();pi != u->endPar();pi++)
+                  cur = better(cur,(*pi)->_from->getBound() + (*pi)->_obj);
+               u->setBound(cur);
+            }
+         }
+      }
+      bool te = !_trg->isExact(); // the sink is exact once every inexact node leading to it is gone
+      for(auto pi = _trg->beginPar();te && pi != _trg->endPar();pi++)
+         te = (*pi)->_from->isExact();
+      if (te)
+         _trg->setExact(true);
+      return changed || te;
+   }
    double local(ANode::Ptr src,LocalContext lc) {
       if (_local) {
          auto op = static_cast<const Node<ST>*>(src.get());
-         return _local(op->get(),lc);
+         return localBound(op->get(),lc);
       }
       else return initialWorst();
    }
    double cost(ANode::Ptr src,int label) {
       auto op = static_cast<const Node<ST>*>(src.get());
-      auto cVal = _stc(op->get(),label);
-      return cVal;
+      if (!_tcache)
+         return _stc(op->get(),label);
+      double cVal = 0;
+      if (successor(op->get(),label,cVal).has_value())
+         return cVal;
+      else return _stc(op->get(),label);
    }
    ANode::Ptr merge(const ANode::Ptr f,const ANode::Ptr s) {
       auto fp = static_cast<const Node<ST>*>(f.get());
@@ -546,11 +1285,39 @@ private:
       }
       else return nullptr;
    }
+   ANode::Ptr merge(std::span<const ANode::Ptr> group) {
+      unsigned lay = 0;
+      _mst.clear();
+      for(auto n : group) {
+         _mst.push_back(&static_cast<const Node<ST>*>(n.get())->get());
+         lay = std::max(lay,n->getLayer());
+      }
+      auto vs = _nmf(_mst);
+      if (vs.has_value()) {
+         ANode::Ptr inMap = hasNode(vs.value());
+         if (inMap && inMap->getLayer() < lay)
+            return nullptr;
+         ANode::Ptr rv = makeNode(std::move(vs.value()));
+         for(auto n : group)
+            if (isBetter(n->getBound(),rv->getBound()))
+               rv->copyBoundAndLabels(n);
+         return rv;
+      }
+      else return nullptr;
+   }
    bool dominates(ANode::Ptr f,ANode::Ptr s) {
       auto fp = static_cast<const Node<ST>*>(f.get());
       auto sp = static_cast<const Node<ST>*>(s.get());
       return _sdom(fp->get(),sp->get());
    }
+   DomKey dominanceKey(ANode::Ptr n) const {
+      auto np = static_cast<const Node<ST>*>(n.get());
+      return _domKey(np->get());
+   }
+   std::size_t mergeKey(ANode::Ptr n) const {
+      auto np = static_cast<const Node<ST>*>(n.get());
+      return _mergeKey(np->get());
+   }
 public:
    DD(std::function<ST()> sti,IBL2 stt,LGF lgf,STF stf,STC stc,SMF smf,
       EQSink eqs,const GNSet& labels,
@@ -578,11 +1345,73 @@ public:
    }
    ~DD() { DD::reset();}
    template <class... Args>
-   static AbstractDD::Ptr makeDD(Args&&... args) {
-      return AbstractDD::Ptr(new DD(std::forward<Args>(args)...));
+   static std::shared_ptr<DD> makeDD(Args&&... args) {
+      return std::shared_ptr<DD>(new DD(std::forward<Args>(args)...));
+   }
+   /**
+    * Optional dominance key (see `DomKey`). Used to index dominance checks when `dom` is given, both in the
+    * B&B open list and in the layer under construction. With a key, a new node also evicts the queued nodes
+    * of its layer that it dominates (their incoming arcs move to it).
+    */
+   void setDominanceKey(std::function<DomKey(const ST&)> dk) { _domKey = dk;}
+   /**
+    * Optional merge-compatibility key. `smf` must refuse to merge two states with different keys. The relaxation
+    * then only looks for merge partners among the nodes of a layer that share the key of the node being merged.
+    */
+   void setMergeKey(std::function<std::size_t(const ST&)> mk) { _mergeKey = mk;}
+   /**
+    * Optional n-ary merge. Merges a whole group of states of a layer at once (nullopt when it refuses the
+    * group). The relaxation then collapses as many nodes as the width requires with a single new node instead
+    * of a chain of pairwise merges. It falls back on `smf` when the group is refused.
+    */
+   void setNaryMerge(std::function<std::optional<ST>(std::span<const ST* const>)> nmf) { _nmf = nmf;}
+   /**
+    * Optional batched expansion. Appends every arc out of a state (label, successor state and cost) to the
+    * buffer it receives, in one call, in place of one `lgf`/`stf`/`stc` round per label. It must produce the
+    * triples the three functions would (feasible labels only, in increasing label order); they are still used
+    * where single transitions are needed (refinement, B&B bookkeeping). The successor cache is then bypassed.
+    */
+   void setExpander(std::function<void(const ST&,DDContext,std::vector<Successor<ST>>&)> exp) { _exp = exp;}
+   /**
+    * Memoizes the local bound by state in a table of at most `nbEntries` entries (CLOCK eviction, 0 = unbounded).
+    * The table is shared by every duplicate of the DD made afterwards: the relaxed and restricted DDs of every
+    * B&B worker and every iteration. The bound must then only depend on the state (not on the `LocalContext`).
+    */
+   void setLocalCache(std::size_t nbEntries) {
+      _lcache = std::make_shared<LocalCache>();
+      _lcache->tab.setCapacity(nbEntries);
+   }
+   /**
+    * Memoizes transitions and arc costs by (state,label) in a table of at most `nbEntries` entries (CLOCK
+    * eviction, 0 = unbounded). Each entry holds two states: size the table for the memory they take. Like the
+    * local bound cache, the table is shared by the duplicates of the DD made afterwards, so the relaxed and
+    * restricted DDs of a `BAndB` reuse the successors computed for each other, across iterations.
+    * `stf` and `stc` must be pure functions of the state and the label.
+    */
+   void setSuccessorCache(std::size_t nbEntries) {
+      _tcache = std::make_shared<TransCache>();
+      _tcache->tab.setCapacity(nbEntries);
+   }
+   void printCaches(std::ostream& os) const {
+      if (_lcache) {
+         std::lock_guard<std::mutex> lock(_lcache->mtx);
+         os << "\t Local:" << _lcache->tab;
+      }
+      if (_tcache) {
+         std::lock_guard<std::mutex> lock(_tcache->mtx);
+         os << "\t Succ:" << _tcache->tab;
+      }
+   }
+   /**
+    * Optional binary state serializer. Lets the B&B move open nodes out of memory (spill files).
+    */
+   void setStateSerializer(std::function<void(std::ostream&,const ST&)> sw,
+                           std::function<ST(std::istream&)> sr) {
+      _sWrite = sw;
+      _sRead  = sr;
    }
    AbstractNodeAllocator::Ptr makeNDAllocator() const noexcept {
-      return std::shared_ptr<DDNodeAllocator<ST>>(new DDNodeAllocator<ST>(new LPool(new Pool)));
+      return std::shared_ptr<DDNodeAllocator<ST,Compare>>(new DDNodeAllocator<ST,Compare>(new LPool(new Pool),_sWrite,_sRead));
    }
    void printNode(std::ostream& os,ANode::Ptr n) const {
       auto sp = static_cast<const Node<ST>*>(n.get());
@@ -590,6 +1419,14 @@ public:
    }
    AbstractDD::Ptr duplicate() {
       auto theDD = new DD(_sti,_stt,_lgf,_stf,_stc,_smf,_eqs,_labels,_local,_sdom);
+      theDD->_domKey = _domKey;
+      theDD->_mergeKey = _mergeKey;
+      theDD->_nmf      = _nmf;
+      theDD->_exp      = _exp;
+      theDD->_lcache   = _lcache;
+      theDD->_tcache   = _tcache;
+      theDD->_sWrite = _sWrite;
+      theDD->_sRead  = _sRead;
       return AbstractDD::Ptr(theDD);
    }
    ANode::Ptr duplicate(const ANode::Ptr src) {
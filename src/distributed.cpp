@@ -0,0 +1,188 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "distributed.hpp"
+#include "RuntimeMonitor.hpp"
+#include <sstream>
+#include <algorithm>
+#include <poll.h>
+
+std::string encodePrimal(double v,const std::vector<int>& inc)
+{
+   std::ostringstream os;
+   writeBin(os,v);
+   writeBin(os,(unsigned)inc.size());
+   for(auto l : inc)
+      writeBin(os,l);
+   return os.str();
+}
+
+void decodePrimal(const std::string& p,double& v,std::vector<int>& inc)
+{
+   std::istringstream is(p);
+   v = readBin<double>(is);
+   inc.resize(readBin<unsigned>(is));
+   for(auto& l : inc)
+      l = readBin<int>(is);
+}
+
+std::string encodeNodes(const std::vector<BBBlob>& nodes)
+{
+   std::ostringstream os;
+   writeBin(os,(unsigned)nodes.size());
+   for(const auto& b : nodes) {
+      writeBin(os,b.key);
+      writeBin(os,(unsigned)b.node.size());
+      os.write(b.node.data(),b.node.size());
+   }
+   return os.str();
+}
+
+std::vector<BBBlob> decodeNodes(const std::string& p)
+{
+   std::istringstream is(p);
+   std::vector<BBBlob> nodes(readBin<unsigned>(is));
+   for(auto& b : nodes) {
+      b.key = readBin<double>(is);
+      b.node.resize(readBin<unsigned>(is));
+      is.read(b.node.data(),b.node.size());
+   }
+   return nodes;
+}
+
+std::string encodeCount(unsigned n)
+{
+   std::ostringstream os;
+   writeBin(os,n);
+   return os.str();
+}
+
+unsigned decodeCount(const std::string& p)
+{
+   std::istringstream is(p);
+   return readBin<unsigned>(is);
+}
+
+bool BBCoordinator::run(Bounds& bnds)
+{
+   struct Peer {
+      Channel::Ptr ch;
+      unsigned     open;  // last known number of open nodes
+      bool         idle;  // waiting for nodes
+      bool         asked; // a donation is pending
+      bool         alive;
+   };
+   Listener lst(_endpoint);
+   if (!lst.ok())
+      return false;
+   std::cout << "Coordinator: waiting for " << _nbp << " processes on " << _endpoint << "\n";
+   std::vector<Peer> peers;
+   for(auto i = 0u;i < _nbp;i++) {
+      auto ch = lst.accept();
+      if (!ch)
+         return false;
+      ch->send((std::uint8_t)BBMsg::Start,encodeCount(i));
+      peers.push_back(Peer { ch, i == 0 ? 1u : 0u, false, false, true }); // rank 0 holds the root
+   }
+   bnds.attach(_dd);
+   const auto start = RuntimeMonitor::now();
+   const auto worse = [this](const BBBlob& a,const BBBlob& b) { return _dd->isBetter(b.key,a.key);};
+   std::vector<BBBlob> pool; // heap of donated nodes, best key on top
+   unsigned nbMoved = 0,nbRelayed = 0;
+   std::vector<pollfd> fds(_nbp);
+   while (true) {
+      for(auto i = 0u;i < _nbp;i++)
+         fds[i] = pollfd { peers[i].alive ? peers[i].ch->fd() : -1, POLLIN, 0 };
+      poll(fds.data(),fds.size(),100);
+      for(auto i = 0u;i < _nbp;i++) {
+         if (fds[i].revents == 0)
+            continue;
+         auto& p = peers[i];
+         std::uint8_t tag;
+         std::string msg;
+         if (!p.ch->recv(tag,msg)) {
+            std::cerr << "Coordinator: lost process " << i << ". Its open nodes are lost.\n";
+            p.alive = p.asked = false;
+            p.idle  = true;
+            continue;
+         }
+         switch((BBMsg)tag) {
+            case BBMsg::Primal: {
+               double v;
+               std::vector<int> inc;
+               decodePrimal(msg,v,inc);
+               if (_dd->isBetter(v,bnds.getPrimal())) {
+                  bnds.setPrimal(v);
+                  bnds.setIncumbent(inc.begin(),inc.end());
+                  for(auto j = 0u;j < _nbp;j++)
+                     if (j != i && peers[j].alive)
+                        peers[j].ch->send(tag,msg);
+                  ++nbRelayed;
+               }
+            }break;
+            case BBMsg::Nodes:
+               for(auto& b : decodeNodes(msg)) {
+                  pool.push_back(std::move(b));
+                  std::push_heap(pool.begin(),pool.end(),worse);
+               }
+               p.asked = false;
+               break;
+            case BBMsg::Status: p.open = decodeCount(msg);break;
+            case BBMsg::Idle:   p.idle = true;p.open = 0;break;
+            default: break;
+         }
+      }
+      // Feed the idle processes from the pool.
+      const auto nbIdle = std::count_if(peers.begin(),peers.end(),[](const Peer& p) { return p.alive && p.idle;});
+      for(auto& p : peers) {
+         if (!p.alive || !p.idle || pool.empty())
+            continue;
+         const auto nb = std::min<std::size_t>({pool.size(),std::max<std::size_t>(1,pool.size() / nbIdle),64});
+         std::vector<BBBlob> batch;
+         for(auto k = 0u;k < nb;k++) {
+            std::pop_heap(pool.begin(),pool.end(),worse);
+            batch.push_back(std::move(pool.back()));
+            pool.pop_back();
+         }
+         p.ch->send((std::uint8_t)BBMsg::Nodes,encodeNodes(batch));
+         p.idle = false;
+         p.open = nb;
+         nbMoved += nb;
+      }
+      // Processes still starving: ask the most loaded one for half of its nodes (one request at a time).
+      const bool starving = std::any_of(peers.begin(),peers.end(),[](const Peer& p) { return p.alive && p.idle;});
+      const bool pending  = std::any_of(peers.begin(),peers.end(),[](const Peer& p) { return p.asked;});
+      if (starving && !pending) {
+         Peer* donor = nullptr;
+         for(auto& p : peers)
+            if (p.alive && !p.idle && p.open > 0 && (!donor || p.open > donor->open))
+               donor = &p;
+         if (donor) {
+            donor->ch->send((std::uint8_t)BBMsg::Donate,encodeCount(std::min(64u,(donor->open + 1) / 2)));
+            donor->asked = true;
+            donor->open  = 0; // until its next status
+         }
+      }
+      const bool allIdle = std::all_of(peers.begin(),peers.end(),[](const Peer& p) { return p.idle;});
+      if (allIdle && pool.empty() && !pending)
+         break;
+   }
+   for(auto& p : peers)
+      if (p.alive)
+         p.ch->send((std::uint8_t)BBMsg::Stop,"");
+   std::cout << "Coordinator done:" << bnds.getPrimal() << "\t moved:" << nbMoved << "\t relayed:" << nbRelayed
+             << "\t Time:" << RuntimeMonitor::elapsedSince(start) / 1000 << "s\n";
+   return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_DISTRIBUTED_H
+#define __DDOPT_DISTRIBUTED_H
+
+#include <string>
+#include <vector>
+#include "dd.hpp"
+#include "channel.hpp"
+
+/**
+ * Messages between the B&B processes and the coordinator.
+ *  - Start  (C->W): rank of the process. Rank 0 compiles the root.
+ *  - Primal (both): improved primal bound and its incumbent. The coordinator relays it to everyone.
+ *  - Nodes  (both): a batch of open nodes (answer to Donate, or work for an idle process).
+ *  - Idle   (W->C): the process ran out of open nodes and waits for Nodes or Stop.
+ *  - Donate (C->W): please send up to k open nodes.
+ *  - Status (W->C): number of open nodes of the process.
+ *  - Stop   (C->W): every process is idle and no node is left. The search is over.
+ */
+enum class BBMsg : std::uint8_t { Start, Primal, Nodes, Idle, Donate, Status, Stop };
+
+/**
+ * An open node on the wire: its key in the open list and its encoding (see `AbstractNodeAllocator::writeNode`).
+ * The coordinator never decodes the node. Only the model-aware processes do.
+ */
+struct BBBlob {
+   double      key;
+   std::string node;
+};
+
+std::string encodePrimal(double v,const std::vector<int>& inc);
+void decodePrimal(const std::string& p,double& v,std::vector<int>& inc);
+std::string encodeNodes(const std::vector<BBBlob>& nodes);
+std::vector<BBBlob> decodeNodes(const std::string& p);
+std::string encodeCount(unsigned n);
+unsigned decodeCount(const std::string& p);
+
+/**
+ * @brief Coordinator of a distributed B&B.
+ * Processes run `BAndB::search` after `BAndB::setRemote(endpoint)`. The coordinator balances the load
+ * (an idle process receives nodes donated by the most loaded one) and relays primal improvements so that
+ * every process prunes with the same bound. The DD only provides the direction of the objective.
+ */
+class BBCoordinator {
+   AbstractDD::Ptr _dd;
+   std::string     _endpoint;
+   unsigned        _nbp;
+public:
+   BBCoordinator(AbstractDD::Ptr dd,const std::string& endpoint,unsigned nbProcs)
+      : _dd(dd),_endpoint(endpoint),_nbp(nbProcs) {}
+   /**
+    * Accepts the processes, then coordinates them until the search is over. The final primal and
+    * incumbent end up in `bnds`.
+    * @return false if the processes could not be reached.
+    */
+   bool run(Bounds& bnds);
+};
+
+#endif
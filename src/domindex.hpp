@@ -0,0 +1,119 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_DOMINDEX_H
+#define __DDOPT_DOMINDEX_H
+
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <iterator>
+
+/**
+ * @brief Dominance key of a state, as provided by the model.
+ * Only states in the same `bucket` can dominate one another and, within a bucket,
+ * the `rank` must be monotone with dominance:  dom(a,b) => a.rank >= b.rank.
+ * For a knapsack state <n,c>, one would use bucket=n and rank=c.
+ */
+struct DomKey {
+   std::size_t bucket;
+   double      rank;
+};
+
+/**
+ * @brief Index of values bucketed by dominance key and sorted by rank within a bucket.
+ * A query for the dominators of a key only visits the entries of its bucket with a rank
+ * at least as large, and a query for the dominated entries only those with a rank at most as large.
+ */
+template <class T> class DomIndex {
+   typedef std::multimap<double,T> Bucket;
+   std::unordered_map<std::size_t,Bucket> _buckets;
+   std::size_t _sz;
+public:
+   DomIndex() : _sz(0) {}
+   std::size_t size() const noexcept { return _sz;}
+   void clear() noexcept { _buckets.clear();_sz = 0;}
+   void insert(const DomKey& k,const T& v) {
+      _buckets[k.bucket].emplace(k.rank,v);
+      ++_sz;
+   }
+   /**
+    * Removes the (first) entry with key `k` satisfying `match`.
+    * @return true if an entry was removed.
+    */
+   template <class Pred> bool remove(const DomKey& k,Pred match) {
+      auto b = _buckets.find(k.bucket);
+      if (b == _buckets.end())
+         return false;
+      auto [from,to] = b->second.equal_range(k.rank);
+      for(auto it = from;it != to;++it)
+         if (match(it->second)) {
+            b->second.erase(it);
+            if (b->second.empty())
+               _buckets.erase(b);
+            --_sz;
+            return true;
+         }
+      return false;
+   }
+   /**
+    * Visits the entries that may dominate a value with key `k` (same bucket, rank >= k.rank).
+    * @return the first entry satisfying `isDom` or `T()` if there is none.
+    */
+   template <class Pred> T findDominator(const DomKey& k,Pred isDom) const {
+      auto b = _buckets.find(k.bucket);
+      if (b != _buckets.end())
+         for(auto it = b->second.lower_bound(k.rank);it != b->second.end();++it)
+            if (isDom(it->second))
+               return it->second;
+      return T();
+   }
+   /**
+    * Same as above, but the visit (by increasing rank) stops at the first entry satisfying `stop`.
+    */
+   template <class Pred,class Stop> T findDominator(const DomKey& k,Pred isDom,Stop stop) const {
+      auto b = _buckets.find(k.bucket);
+      if (b != _buckets.end())
+         for(auto it = b->second.lower_bound(k.rank);it != b->second.end() && !stop(it->second);++it)
+            if (isDom(it->second))
+               return it->second;
+      return T();
+   }
+   /**
+    * Visits the entries that a value with key `k` may dominate (same bucket, rank <= k.rank).
+    */
+   template <class Fun> void forDominated(const DomKey& k,Fun f) const {
+      auto b = _buckets.find(k.bucket);
+      if (b != _buckets.end()) {
+         const auto end = b->second.upper_bound(k.rank);
+         for(auto it = b->second.begin();it != end;++it)
+            f(it->second);
+      }
+   }
+   /**
+    * Same as above, but by decreasing rank (closest to `k` first) and up to the first entry satisfying `stop`.
+    */
+   template <class Fun,class Stop> void forDominated(const DomKey& k,Fun f,Stop stop) const {
+      auto b = _buckets.find(k.bucket);
+      if (b != _buckets.end())
+         for(auto it = std::make_reverse_iterator(b->second.upper_bound(k.rank));it != b->second.rend();++it) {
+            if (stop(it->second))
+               break;
+            f(it->second);
+         }
+   }
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_FRONTIER_H
+#define __DDOPT_FRONTIER_H
+
+#include <vector>
+#include <cassert>
+#include "node.hpp"
+
+/**
+ * @brief Queue of the nodes still to expand during a top-down compilation.
+ * One contiguous bucket per layer (in insertion order), so counting the nodes queued on a layer is O(1)
+ * and a layer is pulled as a whole, ready to be sorted in place. Layers are pulled in increasing order and
+ * the buffers are recycled across layers and compilations. The nodes go to the bucket of the layer given
+ * to `push`, later changes to their layer do not move them. A retracted node leaves a nullptr in its bucket
+ * until the layer is pulled.
+ */
+class Frontier {
+   struct Bucket {
+      std::vector<ANode::Ptr> nodes;
+      std::size_t             holes = 0;
+   };
+   std::vector<Bucket>                  _layers;
+   std::vector<ANode::Ptr>              _cur;   // the last pulled layer
+   unsigned                             _first; // no node is queued below that layer
+   std::size_t                          _nb;
+public:
+   Frontier() : _first(0),_nb(0) {}
+   void clear() noexcept {
+      for(auto& b : _layers) {
+         b.nodes.clear();
+         b.holes = 0;
+      }
+      _cur.clear();
+      _first = 0;
+      _nb = 0;
+   }
+   bool empty() const noexcept { return _nb == 0;}
+   std::size_t size() const noexcept { return _nb;}
+   unsigned pulledLayer() const noexcept { return _first;} // the layer returned by the last `pull`
+   std::size_t size(unsigned layer) const noexcept {
+      return layer < _layers.size() ? _layers[layer].nodes.size() - _layers[layer].holes : 0;
+   }
+   /**
+    * @return the position of `n` in the bucket of `layer` (see `retract`).
+    */
+   std::size_t push(ANode::Ptr n,unsigned layer) {
+      assert(layer >= _first);
+      if (layer >= _layers.size())
+         _layers.resize(layer + 1);
+      _layers[layer].nodes.push_back(n);
+      ++_nb;
+      return _layers[layer].nodes.size() - 1;
+   }
+   /**
+    * Removes the node pushed on `layer` at position `at`.
+    */
+   void retract(unsigned layer,std::size_t at) noexcept {
+      assert(_layers[layer].nodes[at] != nullptr);
+      _layers[layer].nodes[at] = nullptr;
+      _layers[layer].holes++;
+      --_nb;
+   }
+   /**
+    * @return the nodes queued on `layer` (in insertion order, nullptr for the retracted ones).
+    */
+   const std::vector<ANode::Ptr>& at(unsigned layer) const noexcept {
+      static const std::vector<ANode::Ptr> none;
+      return layer < _layers.size() ? _layers[layer].nodes : none;
+   }
+   /**
+    * Dequeues the lowest non-empty layer. The result stays valid (and may be reordered or edited) until the
+    * next call to `pull`.
+    */
+   std::vector<ANode::Ptr>& pull() noexcept {
+      assert(_nb > 0);
+      while (_layers[_first].nodes.size() == _layers[_first].holes) {
+         _layers[_first].nodes.clear();
+         _layers[_first++].holes = 0;
+      }
+      auto& b = _layers[_first];
+      _cur.clear();
+      std::swap(_cur,b.nodes);
+      if (b.holes) {
+         std::erase(_cur,nullptr);
+         b.holes = 0;
+      }
+      _nb -= _cur.size();
+      return _cur;
+   }
+};
+
+#endif
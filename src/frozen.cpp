@@ -0,0 +1,97 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "frozen.hpp"
+#include <algorithm>
+
+void FrozenDD::order(const ANList& an,unsigned nbIds)
+{
+   std::size_t nbn = 0;
+   unsigned mxl = 0;
+   bool layered = true; // every arc goes down at least one layer
+   for(auto n : an) {
+      ++nbn;
+      mxl = std::max(mxl,n->getLayer());
+      for(auto pi = n->beginPar();layered && pi != n->endPar();pi++)
+         layered = (*pi)->_from->getLayer() < n->getLayer();
+   }
+   _node.resize(nbn);
+   if (layered) { // bucket the nodes by layer (counting sort)
+      _cnt.assign(mxl + 2,0);
+      for(auto n : an)
+         _cnt[n->getLayer() + 1]++;
+      for(auto l = 1u;l < _cnt.size();l++)
+         _cnt[l] += _cnt[l - 1];
+      for(auto n : an)
+         _node[_cnt[n->getLayer()]++] = n;
+   } else {
+      _cnt.assign(nbIds,0);
+      std::size_t h = 0,t = 0;
+      for(auto n : an)
+         if ((_cnt[n->getId()] = n->nbParents()) == 0)
+            _node[t++] = n;
+      while (h < t) {
+         auto n = _node[h++];
+         for(auto ki = n->beginKids(); ki != n->endKids();ki++)
+            if (--_cnt[(*ki)->_to->getId()] == 0)
+               _node[t++] = (*ki)->_to;
+      }
+      assert(t == nbn);
+   }
+}
+
+void FrozenDD::freeze(const ANList& an,unsigned nbIds)
+{
+   order(an,nbIds);
+   const auto nbn = _node.size();
+   _idx.resize(nbIds);
+   _inOff.resize(nbn + 1);
+   _outOff.resize(nbn + 1);
+   _fb.resize(nbn);
+   _bb.resize(nbn);
+   _exact.resize(nbn);
+   Idx nbIn = 0,nbOut = 0;
+   for(auto i = 0u;i < nbn;i++) {
+      auto n = _node[i];
+      _idx[n->getId()] = i;
+      _inOff[i]  = nbIn;
+      _outOff[i] = nbOut;
+      nbIn  += n->nbParents();
+      nbOut += n->nbChildren();
+      _fb[i] = n->getBound();
+      _bb[i] = n->getBackwardBound();
+      _exact[i] = n->isExact();
+   }
+   _inOff[nbn]  = nbIn;
+   _outOff[nbn] = nbOut;
+   _src.resize(nbIn);
+   _inObj.resize(nbIn);
+   _dst.resize(nbOut);
+   _outObj.resize(nbOut);
+   for(auto i = 0u;i < nbn;i++) {
+      auto n = _node[i];
+      auto a = _inOff[i];
+      for(auto pi = n->beginPar();pi != n->endPar();pi++,a++) {
+         _src[a]    = _idx[(*pi)->_from->getId()];
+         _inObj[a]  = (*pi)->_obj;
+      }
+      a = _outOff[i];
+      for(auto ki = n->beginKids();ki != n->endKids();ki++,a++) {
+         _dst[a]    = _idx[(*ki)->_to->getId()];
+         _outObj[a] = (*ki)->_obj;
+      }
+   }
+   _frozen = true;
+}
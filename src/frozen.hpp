@@ -0,0 +1,70 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_FROZEN_H
+#define __DDOPT_FROZEN_H
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include "node.hpp"
+
+/**
+ * @brief Compact read-only copy of a compiled diagram for the passes that follow the compilation.
+ * Nodes are numbered in topological order and their arcs are stored contiguously in both directions (CSR):
+ * 32-bit node indices and the arc costs, in structure-of-arrays form. The forward and backward bounds and
+ * the exactness of the nodes are copied as well, so a pass only touches the arrays. The incoming arcs of a
+ * node are in the order of its parents (`ANode::parent`). The diagram must not change while it is frozen.
+ */
+class FrozenDD {
+public:
+   typedef std::uint32_t Idx;
+private:
+   std::vector<ANode::Ptr> _node;          // by index, in topological order
+   std::vector<Idx>        _idx;           // node id -> index
+   std::vector<Idx>        _inOff,_outOff; // arcs of node i: [off[i],off[i+1])
+   std::vector<Idx>        _src,_dst;
+   std::vector<double>     _inObj,_outObj;
+   std::vector<double>     _fb,_bb;        // forward and backward bounds
+   std::vector<char>       _exact;
+   std::vector<unsigned>   _cnt;
+   bool                    _frozen;
+   void order(const ANList& an,unsigned nbIds);
+public:
+   FrozenDD() : _frozen(false) {}
+   /**
+    * Nodes are bucketed by layer when every arc goes down at least one layer, otherwise they are ordered
+    * by in-degree (a node reached again deeper than its children).
+    */
+   void freeze(const ANList& an,unsigned nbIds);
+   void thaw() noexcept { _frozen = false;}
+   bool frozen() const noexcept { return _frozen;}
+   std::size_t size() const noexcept { return _node.size();}
+   ANode::Ptr node(Idx i) const noexcept { return _node[i];}
+   Idx index(ANode::Ptr n) const noexcept { return _idx[n->getId()];}
+   Idx inBegin(Idx i) const noexcept  { return _inOff[i];}
+   Idx inEnd(Idx i) const noexcept    { return _inOff[i+1];}
+   Idx outBegin(Idx i) const noexcept { return _outOff[i];}
+   Idx outEnd(Idx i) const noexcept   { return _outOff[i+1];}
+   Idx src(Idx a) const noexcept { return _src[a];}
+   Idx dst(Idx a) const noexcept { return _dst[a];}
+   double inObj(Idx a) const noexcept  { return _inObj[a];}
+   double outObj(Idx a) const noexcept { return _outObj[a];}
+   double& bound(Idx i) noexcept  { return _fb[i];}
+   double& bbound(Idx i) noexcept { return _bb[i];}
+   bool exact(Idx i) const noexcept { return _exact[i];}
+};
+
+#endif
@@ -142,6 +142,9 @@ public:
       ++_at;
       return _data[_at-1];
    }
+   bool holds(const Location* at) const noexcept { // `at` is in the heap (locations are recycled on removal)
+      return at->_p > 0 && at->_p < _at && _data[at->_p] == at;
+   }
    Location* find(const T& v) {
       for(int i=1;i<_mxs;i++)
          if (_data[i]->_val == v)
@@ -156,7 +159,7 @@ public:
       sendToRoot(at->_p);
       return extractMax();
    }
-   const Location* insertHeap(const T& v) noexcept {
+   Location* insertHeap(const T& v) noexcept {
       auto loc = insert(v);
       refloat(_at-1);
       return loc;
@@ -1,5 +1,6 @@
 #include "node.hpp"
 #include <iostream>
+#include <algorithm>
 
 void print(const ANList& l) {
    std::cout << l << "\n";
@@ -20,11 +21,13 @@ ANode::ANode(Pool::Ptr mem,unsigned nid,bool exact)
    : _parents(mem,2),
      _children(mem,2),
      _optLabels(mem),
+     _best(nullptr),
      _bound(0),
      _bbound(0),
      _layer(0),
      _exact(exact),
      _nid(nid),
+     _depth(0),
      _next(nullptr),
      _prev(nullptr)
      
@@ -33,27 +36,44 @@ ANode::ANode(Pool::Ptr mem,unsigned nid,bool exact)
 ANode::ANode(Pool::Ptr mem,unsigned nid,const ANode& o,bool exact)
    : _parents(mem,2),
      _children(mem,2),
-     _optLabels(mem,o._optLabels),
+     _optLabels(mem),
+     _best(nullptr),
      _bound(o._bound),
      _bbound(o._bbound),
      _layer(0),
      _exact(exact),
      _nid(nid),
+     _depth(0),
      _next(nullptr),
      _prev(nullptr)    
-{}
+{
+   setIncumbent(o.optLabels()); // the copy lives in another pool: it keeps the whole path
+}
 
 void ANode::reset()
 {
    _parents.clear();
    _children.clear();
    _optLabels.clear();
+   _best = nullptr;
    _bound = _bbound = 0;
    _layer = 0;
+   _depth = 0;
    _exact = true;
    _next = _prev = nullptr;
 }
 
+std::vector<int> ANode::optLabels() const
+{
+   std::vector<int> lbls;
+   const ANode* n = this;
+   for(;n->_best;n = n->_best->_from.get())
+      lbls.push_back(n->_best->_lbl);
+   lbls.insert(lbls.end(),n->_optLabels.rbegin(),n->_optLabels.rend());
+   std::reverse(lbls.begin(),lbls.end());
+   return lbls;
+}
+
 void ANode::addArc(Edge::Ptr ep)
 {
    if (ep->_from == this)
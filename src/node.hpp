@@ -4,6 +4,7 @@
 #include <functional>
 #include <iterator>
 #include <stack>
+#include <vector>
 #include "vec.hpp"
 
 template<typename T>
@@ -43,12 +44,14 @@ public:
 protected:
    Vec<Edge::Ptr,unsigned> _parents;
    Vec<Edge::Ptr,unsigned> _children;
-   Vec<int,unsigned>       _optLabels;
+   Vec<int,unsigned>       _optLabels; // best path to the root of the diagram (only when _best is nullptr)
+   Edge::Ptr               _best;      // best incoming arc, its source holds the rest of the path
    double                  _bound;
    double                  _bbound;
    unsigned                _layer:31; // will be used in restricted / (relaxed?)
    unsigned                _exact:1;  // true if node is exact
    unsigned                _nid;
+   unsigned                _depth;     // decisions on the best path from the root of the B&B
    ANode::Ptr              _next,_prev;
    void addArc(Edge::Ptr ep);
 public:
@@ -71,25 +74,37 @@ public:
    auto nbParents() const noexcept    { return _parents.size();}
    auto nbChildren() const noexcept   { return _children.size();}
    auto beginPar()  { return _parents.begin();}
+   Edge::Ptr parent(unsigned k) const noexcept { return _parents[k];} // k-th incoming arc
    auto endPar()    { return _parents.end();}
    auto beginKids() { return _children.begin();}
    auto endKids()   { return _children.end();}
-   auto beginOptLabels() { return _optLabels.begin();}
-   auto endOptLabels() { return _optLabels.end();}
    void setBound(double b) { _bound = b;}
    void setBackwardBound(double b) { _bbound = b;}
-   const auto depth() const { return _optLabels.size();}
+   unsigned depth() const noexcept { return _depth;} // set with the best incoming arc (see `setBest`)
    const auto getBound() const { return _bound;}
    const auto getBackwardBound() const { return _bbound;}
-   const Vec<int,unsigned>& getIncumbent() const noexcept { return _optLabels;}
+   /**
+    * Labels of the best path to this node, rebuilt from the best incoming arcs. Only called when an
+    * incumbent is reported or when the node leaves the diagram (B&B node), so arcs do not copy paths.
+    */
+   std::vector<int> optLabels() const;
+   void setBest(Edge::Ptr e) noexcept {
+      _best = e;
+      _depth = e ? e->_from->_depth + 1 : _optLabels.size();
+   }
    void setIncumbent(auto begin,auto end) {
       for(auto it = begin;it != end;it++)
          _optLabels.push_back(*it);
+      if (!_best)
+         _depth = _optLabels.size();
    }
+   void setIncumbent(const std::vector<int>& lbls) { setIncumbent(lbls.begin(),lbls.end());}
    void copyBoundAndLabels(ANode::Ptr n) {
       _bound = n->_bound;
       _bbound = n->_bbound;
       _optLabels = n->_optLabels;
+      _best = n->_best;
+      _depth = n->_depth;
       _exact = false;
    }
    const auto getId() const noexcept { return _nid;}
@@ -197,17 +212,22 @@ public:
    const T& get() const noexcept { return _val;}
    void resetWith(const Node<T>* val) noexcept {
       reset();
-      _optLabels = val->_optLabels;
+      setIncumbent(val->optLabels());
       _bound = val->_bound;
       _bbound = val->_bbound;
       _val = val->_val;
    }
+   void resetWith(T&& v) noexcept {
+      reset();
+      _val = std::move(v);
+   }
    void print(std::ostream& os) const {
       os << _nid << ','
          << (_exact ? "T" : "F") << ','
          << _val << ",B=" << _bound << ",BB=" << _bbound << ",LBLS:[";
-      for(auto i=0u;i < _optLabels.size();i++)
-         os << i << ':' << _optLabels[i] << " ";
+      const auto lbls = optLabels();
+      for(auto i=0u;i < lbls.size();i++)
+         os << i << ':' << lbls[i] << " ";
       os << "]";
    }
 };
@@ -7,10 +7,13 @@
 class LPool {
    Pool::Ptr _mem;
    unsigned  _id;
+   std::size_t _live;  // nodes handed out and not released
+   std::size_t _made;  // nodes made on the pool (recycled ones excluded)
+   std::size_t _bytes; // pool bytes taken by the nodes made
    std::stack<ANode::Ptr> _free;
 public:
    typedef LPool* Ptr; // space saving measure
-   LPool(Pool::Ptr mem) : _mem(mem),_id(0) {}
+   LPool(Pool::Ptr mem) : _mem(mem),_id(0),_live(0),_made(0),_bytes(0) {}
    unsigned grabId() noexcept     { return _id++;}
    Pool::Ptr get() const noexcept {  return _mem;}
    ANode::Ptr claimNode() {
@@ -19,10 +22,17 @@ public:
       else {
          ANode::Ptr nd = _free.top();
          _free.pop();
+         ++_live;
          return nd;
       }
    }
-   void release(ANode::Ptr n) { _free.push(n);}
+   void made(std::size_t bytes) noexcept { ++_live;++_made;_bytes += bytes;} // a new node took `bytes` of the pool
+   void release(ANode::Ptr n) { _free.push(n);--_live;}
+   /**
+    * Estimated bytes of the nodes handed out and not released yet (the pool itself never shrinks).
+    */
+   std::size_t liveBytes() const noexcept { return _made ? _live * (_bytes / _made) : 0;}
+   std::size_t liveNodes() const noexcept { return _live;}
 };
 
 #endif
@@ -0,0 +1,58 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "portfolio.hpp"
+#include "RuntimeMonitor.hpp"
+#include <thread>
+#include <atomic>
+
+int Portfolio::search(Bounds& bnds)
+{
+   bnds.attach(_theDD);
+   std::atomic<int> winner = -1;
+   const auto start = RuntimeMonitor::now();
+   const auto lim = _timeLimit;
+   _proved.assign(_cfg.size(),false);
+   std::vector<AbstractDD::Ptr> dds;
+   for(auto i = 0u;i < _cfg.size();i++)
+      dds.push_back(_theDD->duplicate());
+   const auto run = [&](unsigned i) {
+      const auto& c = _cfg[i];
+      BAndB engine(dds[i],c.width,c.nbWorkers);
+      engine.setRestrictedWidth(c.rWidth);
+      engine.setDominance(c.dominance);
+      engine.setAdaptiveWidth(c.adaptive);
+      engine.setNodeSelection(c.selection);
+      engine.setCutSet(c.cutSet);
+      engine.setCompileThreads(c.nbCompile);
+      engine.setTimeLimit([&winner,&lim](double t) { return winner >= 0 || (lim && lim(t));});
+      engine.search(bnds);
+      int none = -1;
+      _proved[i] = engine.proved();
+      if (engine.proved())
+         winner.compare_exchange_strong(none,(int)i);
+   };
+   std::vector<std::thread> threads;
+   for(auto i = 0u;i < _cfg.size();i++)
+      threads.emplace_back(run,i);
+   for(auto& t : threads)
+      t.join();
+   std::cout << "Portfolio done:" << bnds.getPrimal();
+   if (winner >= 0)
+      std::cout << "\t proved by " << winner << ":" << _cfg[winner];
+   else std::cout << "\t not proved";
+   std::cout << "\t Time:" << RuntimeMonitor::elapsedSince(start) / 1000 << "s\n";
+   return winner;
+}
@@ -0,0 +1,70 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_PORTFOLIO_H
+#define __DDOPT_PORTFOLIO_H
+
+#include <vector>
+#include <functional>
+#include "search.hpp"
+
+/**
+ * @brief One configuration of a portfolio: the widths of the relaxed and restricted DDs
+ * (0 = same as the relaxed one), dominance on the open list, number of worker threads,
+ * adaptive widths, node selection, cutset and threads per DD compilation.
+ */
+struct BBConfig {
+   unsigned width;
+   unsigned rWidth    = 0;
+   bool     dominance = true;
+   unsigned nbWorkers = 1;
+   bool     adaptive  = false; // see `BAndB::setAdaptiveWidth`
+   NodeSelection::Ptr selection = nullptr; // best first by default
+   CutSetType cutSet = CSFrontier;
+   unsigned nbCompile = 1; // see `BAndB::setCompileThreads`
+   friend std::ostream& operator<<(std::ostream& os,const BBConfig& c) {
+      return os << "<W:" << c.width << ",RW:" << (c.rWidth ? c.rWidth : c.width)
+                << ",DOM:" << c.dominance << ",T:" << c.nbWorkers << ",A:" << c.adaptive
+                << ",S:" << (c.selection ? c.selection->getName() : "BestFirst")
+                << ",CS:" << (c.cutSet == CSFrontier ? "FC" : "LEL") << ",C:" << c.nbCompile << ">";
+   }
+};
+
+/**
+ * @brief Runs several B&B configurations concurrently on the same model.
+ * Every configuration uses the same `Bounds`, so an incumbent found by one prunes all the others.
+ * The portfolio stops as soon as one configuration proves optimality (or on the time limit).
+ */
+class Portfolio {
+   AbstractDD::Ptr _theDD;
+   std::vector<BBConfig> _cfg;
+   std::vector<char>     _proved; // configurations that closed the gap in the last search
+   std::function<bool(double)> _timeLimit;
+public:
+   Portfolio(AbstractDD::Ptr dd) : _theDD(dd),_timeLimit(nullptr) {}
+   void add(const BBConfig& c) { _cfg.push_back(c);}
+   void setTimeLimit(std::function<bool(double)> lim) { _timeLimit = lim;} // shared by every configuration (see `BAndB::setTimeLimit`)
+   /**
+    * @return the index of the configuration that proved optimality, -1 if none did.
+    */
+   int search(Bounds& bnds);
+   /**
+    * @return true when configuration `i` closed the gap during the last search. The others were stopped
+    * by the winner (or by the time limit).
+    */
+   bool proved(unsigned i) const noexcept { return i < _proved.size() && _proved[i];}
+};
+
+#endif
@@ -3,10 +3,21 @@
 #include "heap.hpp"
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <unistd.h>
 #include <stdlib.h>
 #include "RuntimeMonitor.hpp"
 #include "pool.hpp"
+#include "domindex.hpp"
+#include "distributed.hpp"
+#include <sstream>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <string>
 
 struct QNode {
    ANode::Ptr node;
@@ -18,45 +29,654 @@ struct QNode {
    }
 };
 
-void BAndB::search(Bounds& bnds)
-{
-   auto bbPool = _theDD->makeNDAllocator();
-   using namespace std;
-   unsigned int nbSeen = 0;
-   std::streamsize ss = cout.precision();
-   auto start = RuntimeMonitor::cputime();
-   auto last = start;
-   cout << "B&B searching..." << endl;
-   bnds.attach(_theDD);
-   double optTime = 0.0;
-   bnds.onSolution([ss,start,&optTime](const auto& lbls) {
-      optTime = RuntimeMonitor::elapsedSince(start);
-      std::cout << "TIME:" << setprecision(ss) << optTime << "\n";
-   });
-   AbstractDD::Ptr relaxed = _theDD->duplicate();
-   AbstractDD::Ptr restricted = _theDD->duplicate();
-   WidthBounded* ddr[2];
-   //_theDD->setStrategy(new Exact);
-   relaxed->setStrategy(ddr[0] = new Relaxed(_mxw));
-   restricted->setStrategy(ddr[1] = new Restricted(_mxw));
-   auto hOrder = [relaxed](const QNode& a,const QNode& b) {
-      return relaxed->isBetter(a.bound,b.bound);
+struct QNodeOrder {
+   AbstractDD* _dd;
+   bool operator()(const QNode& a,const QNode& b) const {
+      return _dd->isBetter(a.bound,b.bound);
+   }
+};
+
+typedef Heap<QNode,QNodeOrder> BBHeap;
+
+/**
+ * Open list of a worker: a heap ordered by bound. When the model provides a dominance key,
+ * open nodes are also indexed by that key so that dominance checks only visit comparable
+ * nodes and dominated nodes leave the heap in logarithmic time.
+ * With a memory budget, the worst half of the heap is written to a spill file (as a *run*, best
+ * node first) once the live nodes exceed the budget. A run is read back when the heap runs dry or
+ * when its best key beats the top of the heap, up to the budget (at least one node). The file space
+ * of the nodes read back is reused by later runs. Spilled nodes are not visible to dominance checks.
+ */
+class OpenList {
+   struct Run {
+      std::streamoff at,end; // extent of the run in the spill file
+      unsigned       nb;     // number of nodes in the run
+      double         best;   // best key of the run
+   };
+   struct Hole {
+      std::streamoff at,end; // free extent of the spill file
    };
-   Heap<QNode,decltype(hOrder)> pq(bbPool->get(),64000,hOrder);
-   ANode::Ptr rootNode = bbPool->cloneNode(relaxed->init());
-   if (relaxed->hasLocal()) {
-      auto dualRootValue = relaxed->local(rootNode,LocalContext::BBCtx);
-      cout << "dual@root:" << dualRootValue << "\n";
+   AbstractDD*                _dd;
+   AbstractNodeAllocator::Ptr _alloc;
+   BBHeap                     _pq;
+   DomIndex<BBHeap::LocType*> _dix;
+   const bool                 _indexed;
+   std::size_t                _budget;  // bytes of node storage before spilling (0 = no limit)
+   unsigned                   _spillAt; // smallest heap worth spilling
+   std::string                _fName;
+   std::fstream               _spill;
+   std::vector<Run>           _runs;
+   std::vector<Hole>          _holes;  // by increasing offset, never adjacent
+   std::streamoff             _eof;    // end of the used part of the spill file
+   unsigned                   _nbSpilled;
+   unsigned                   _nbRuns,_nbRestores;
+   void unindex(const QNode& q) {
+      if (_indexed)
+         _dix.remove(_dd->dominanceKey(q.node),[&q](BBHeap::LocType* l) { return l->value().node == q.node;});
+   }
+   void push(const QNode& q) { // no heap order restoration. Caller must buildHeap.
+      auto loc = _pq.insert(q);
+      if (_indexed)
+         _dix.insert(_dd->dominanceKey(q.node),loc);
+   }
+   void spill();
+   void restore();
+   std::streamoff place(std::streamoff len);
+   void reclaim(std::streamoff at,std::streamoff end);
+public:
+   OpenList(AbstractNodeAllocator::Ptr alloc,AbstractDD* dd,std::size_t budget)
+      : _dd(dd),_alloc(alloc),_pq(alloc->get(),64000,QNodeOrder { dd }),_indexed(dd->hasDominanceKey()),
+        _budget(alloc->canSerialize() ? budget : 0),_spillAt(1024),_eof(0),_nbSpilled(0),_nbRuns(0),_nbRestores(0)
+   {}
+   ~OpenList();
+   bool empty() const noexcept    { return _pq.empty() && _runs.empty();}
+   unsigned size() const noexcept { return _pq.size() + _nbSpilled;}
+   bool canSteal() const noexcept { return !_pq.empty();}
+   double bestKey() { // requires !empty()
+      if (_pq.empty())
+         return bestRun()->best;
+      return _runs.empty() ? _pq[0]->value().bound : _dd->better(_pq[0]->value().bound,bestRun()->best);
+   }
+   BBHeap::LocType* insert(const QNode& q) { // the location is only valid while `holds` says so
+      auto loc = _pq.insertHeap(q);
+      if (_indexed)
+         _dix.insert(_dd->dominanceKey(q.node),loc);
+      if (_budget && _pq.size() >= _spillAt && _alloc->liveBytes() > _budget)
+         spill();
+      return loc;
+   }
+   bool holds(BBHeap::LocType* l,ANode::Ptr n) const noexcept { // `n` is still open, at `l`
+      return _pq.holds(l) && l->value().node == n;
+   }
+   QNode take(BBHeap::LocType* l) { // requires holds(l,_)
+      auto q = _pq.remove(l);
+      unindex(q);
+      return q;
+   }
+   QNode extract() {
+      if (!_runs.empty() && (_pq.empty() || _dd->isBetter(bestRun()->best,_pq[0]->value().bound)))
+         restore();
+      auto q = _pq.extractMax();
+      unindex(q);
+      return q;
+   }
+   QNode steal() { // only takes from memory: the spill file belongs to the owner's thread
+      auto q = _pq.extractMax();
+      unindex(q);
+      return q;
+   }
+   bool dominated(ANode::Ptr n,unsigned& pruned);
+   void save(std::ostream& os);
+   unsigned nbRuns() const noexcept     { return _nbRuns;}     // runs spilled so far
+   unsigned nbRestores() const noexcept { return _nbRestores;} // reads of runs (complete or partial)
+   std::vector<Run>::iterator bestRun() {
+      return std::min_element(_runs.begin(),_runs.end(),[this](const Run& a,const Run& b) {
+         return _dd->isBetter(a.best,b.best);
+      });
+   }
+};
+
+OpenList::~OpenList()
+{
+   if (_spill.is_open()) {
+      _spill.close();
+      std::filesystem::remove(_fName);
+   }
+}
+
+void OpenList::spill()
+{
+   if (!_spill.is_open()) {
+      static std::atomic<unsigned> nbFiles = 0;
+      _fName = (std::filesystem::temp_directory_path() /
+                ("ddopt-" + std::to_string(getpid()) + "-" + std::to_string(nbFiles++) + ".spill")).string();
+      _spill.open(_fName,std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+      if (!_spill.is_open()) {
+         std::cerr << "B&B: cannot open spill file " << _fName << ". Memory budget ignored.\n";
+         _budget = 0;
+         return;
+      }
+   }
+   std::vector<QNode> all;
+   all.reserve(_pq.size());
+   for(auto k = 0u;k < _pq.size();k++)
+      all.push_back(_pq[k]->value());
+   const auto keep = all.size() / 2;
+   std::nth_element(all.begin(),all.begin() + keep,all.end(),QNodeOrder { _dd });
+   std::sort(all.begin() + keep,all.end(),QNodeOrder { _dd }); // a run is read back best first
+   _pq.clear();
+   _dix.clear();
+   for(auto i = 0u;i < keep;i++)
+      push(all[i]);
+   _pq.buildHeap();
+   std::ostringstream buf(std::ios::binary);
+   for(auto i = keep;i < all.size();i++) {
+      writeBin(buf,all[i].bound);
+      _alloc->writeNode(buf,all[i].node);
+      _alloc->release(all[i].node);
+   }
+   const auto bytes = buf.str();
+   Run r { place(bytes.size()), 0, (unsigned)(all.size() - keep), all[keep].bound };
+   r.end = r.at + (std::streamoff)bytes.size();
+   _spill.seekp(r.at);
+   _spill.write(bytes.data(),bytes.size());
+   _spill.flush();
+   _runs.push_back(r);
+   _nbSpilled += r.nb;
+   ++_nbRuns;
+}
+
+/**
+ * @return the offset of `len` free bytes of the spill file: the first hole large enough, else the end.
+ */
+std::streamoff OpenList::place(std::streamoff len)
+{
+   for(auto h = _holes.begin();h != _holes.end();h++)
+      if (h->end - h->at >= len) {
+         const auto at = h->at;
+         h->at += len;
+         if (h->at == h->end)
+            _holes.erase(h);
+         return at;
+      }
+   const auto at = _eof;
+   _eof += len;
+   return at;
+}
+
+/**
+ * Returns `[at,end)` to the free space of the spill file.
+ */
+void OpenList::reclaim(std::streamoff at,std::streamoff end)
+{
+   if (at == end)
+      return;
+   auto h = std::lower_bound(_holes.begin(),_holes.end(),at,[](const Hole& x,std::streamoff v) { return x.at < v;});
+   h = _holes.insert(h,Hole { at,end });
+   if (h + 1 != _holes.end() && h->end == (h + 1)->at) { // merge with the next hole
+      h->end = (h + 1)->end;
+      _holes.erase(h + 1);
+   }
+   if (h != _holes.begin() && (h - 1)->end == h->at) { // and with the previous one
+      (h - 1)->end = h->end;
+      h = _holes.erase(h) - 1;
+   }
+   if (h->end == _eof) {
+      _eof = h->at;
+      _holes.erase(h);
+   }
+}
+
+void OpenList::restore()
+{
+   auto bi = bestRun();
+   _spill.seekg(bi->at);
+   auto k = 0u;
+   for(;k < bi->nb && (k == 0 || _alloc->liveBytes() <= _budget);k++) {
+      auto key = readBin<double>(_spill);
+      push(QNode { _alloc->readNode(_spill), key });
+   }
+   _pq.buildHeap();
+   _nbSpilled -= k;
+   ++_nbRestores;
+   if (k == bi->nb) {
+      reclaim(bi->at,bi->end);
+      _runs.erase(bi);
+   } else { // the budget is met: the rest of the run stays on disk
+      const auto at = (std::streamoff)_spill.tellg();
+      reclaim(bi->at,at);
+      bi->at    = at;
+      bi->nb   -= k;
+      bi->best  = readBin<double>(_spill);
+   }
+}
+
+/**
+ * Writes every open node (key, then node) to `os`, resident ones first.
+ * Spilled runs use the same encoding and are copied verbatim.
+ */
+void OpenList::save(std::ostream& os)
+{
+   for(auto k = 0u;k < _pq.size();k++) {
+      const auto q = _pq[k]->value();
+      writeBin(os,q.bound);
+      _alloc->writeNode(os,q.node);
+   }
+   std::vector<char> buf(1 << 20);
+   for(const auto& r : _runs) {
+      _spill.seekg(r.at);
+      for(auto left = r.end - r.at;left > 0;) {
+         const auto nb = std::min<std::streamoff>(left,buf.size());
+         _spill.read(buf.data(),nb);
+         os.write(buf.data(),nb);
+         left -= nb;
+      }
+   }
+}
+
+/**
+ * Dominance filtering of a candidate node `n` against the open list.
+ * @return true when an open node dominates `n`. Open nodes dominated by `n` are
+ * removed and counted in `pruned`.
+ */
+bool OpenList::dominated(ANode::Ptr n,unsigned& pruned)
+{
+   bool newGuyDominated = false;
+   std::vector<BBHeap::LocType*> allLocs;
+   if (_indexed) {
+      const auto k = _dd->dominanceKey(n);
+      newGuyDominated = _dix.findDominator(k,[this,n](BBHeap::LocType* l) {
+         auto o = l->value().node;
+         return _dd->isBetterEQ(o->getBound(),n->getBound()) && _dd->dominates(o,n);
+      }) != nullptr;
+      if (!newGuyDominated)
+         _dix.forDominated(k,[this,n,&allLocs](BBHeap::LocType* l) {
+            auto o = l->value().node;
+            if (_dd->isBetterEQ(n->getBound(),o->getBound()) && _dd->dominates(n,o))
+               allLocs.push_back(l);
+         });
+   } else {
+      auto pqSz = _pq.size();
+      for(unsigned k = 0;k < pqSz;k++) {
+         auto bbn = _pq[k];
+         bool isObjDom   = _dd->isBetterEQ(bbn->value().node->getBound(),n->getBound());
+         newGuyDominated = isObjDom && _dd->dominates(bbn->value().node,n);
+         if (newGuyDominated)
+            break;
+         bool objDom   = _dd->isBetterEQ(n->getBound(),bbn->value().node->getBound());
+         bool qnDominated = objDom && _dd->dominates(n,bbn->value().node);
+         if (qnDominated)
+            allLocs.push_back(bbn);
+      }
+   }
+   //std::cout << "new BBNode Dominated " << allLocs.size() << " BB nodes" << std::endl;
+   for(auto l : allLocs) {
+      auto q = _pq.remove(l);
+      unindex(q);
+      _alloc->release(q.node);
+   }
+   pruned += allLocs.size();
+   return newGuyDominated;
+}
+
+class BBWorker;
+
+/**
+ * State shared by all the workers of a single B&B search: bounds, statistics
+ * and the termination protocol. A worker is *idle* when its own open list is
+ * empty and it holds no node. Once every worker is idle, the search is over.
+ * Checkpoints are taken when every worker is *parked*: between two nodes or idle,
+ * so that all open nodes sit in the open lists.
+ */
+struct BBShared {
+   Bounds&                     bnds;
+   std::function<bool(double)> timeLimit;
+   std::vector<BBWorker*>      workers;
+   RuntimeMonitor::HRClock     start,last;
+   std::atomic<unsigned>       nbIdle;
+   std::atomic<bool>           stop;
+   std::atomic<unsigned>       nNode,ttlNode,insDom,pruned,nbSeen;
+   std::atomic<unsigned>       nbMoving,nbMoved; // steals under way and done (see `BBWorker::openBound`)
+   std::size_t                 ttCap;  // capacity of the transposition table (shared by the workers)
+   std::size_t                 budget; // bytes of B&B node storage per worker (0 = no limit)
+   std::string                 ckFile;   // checkpoint file (empty = no checkpoint)
+   double                      ckPeriod; // milliseconds between checkpoints
+   RuntimeMonitor::HRClock     ckLast;
+   std::atomic<bool>           ckPending;
+   std::mutex                  ckMtx;
+   std::condition_variable     ckCV;
+   unsigned                    nbParked,ckGen;
+   Channel::Ptr                link;       // to the coordinator of a distributed search
+   std::mutex                  linkMtx;
+   double                      sentPrimal; // last primal bound published to the coordinator
+   RuntimeMonitor::HRClock     lastStatus;
+   std::atomic<bool>           done;       // the coordinator declared the search over
+   bool                        useDom;     // dominance checks on the open lists
+   bool                        domStop;    // bounded in-layer dominance scans
+   bool                        adaptive;   // workers tune their widths (see `WidthControl`)
+   NodeSelection::Ptr          sel;        // plunging policy (nullptr = best first)
+   CutSetType                  cutSet;
+   bool                        refine;     // relaxed DDs by incremental refinement
+   unsigned                    nbCompile;  // threads expanding the layers of a worker's DDs
+   BBShared(Bounds& b,std::function<bool(double)> lim,std::size_t cap,std::size_t mem)
+      : bnds(b),timeLimit(lim),nbIdle(0),stop(false),
+        nNode(0),ttlNode(0),insDom(0),pruned(0),nbSeen(0),nbMoving(0),nbMoved(0),ttCap(cap),budget(mem),
+        ckPeriod(0),ckPending(false),nbParked(0),ckGen(0),sentPrimal(0),done(false),useDom(true),domStop(false),adaptive(false),cutSet(CSFrontier),refine(false),nbCompile(1)
+   {
+      start = last = ckLast = lastStatus = RuntimeMonitor::cputime();
+   }
+   void halt() {
+      stop = true;
+      std::lock_guard<std::mutex> lk(ckMtx);
+      ckCV.notify_all();
+   }
+   void checkpointIfDue();
+   void park();
+   void saveCheckpoint();
+   bool loadCheckpoint(std::istream& is);
+};
+
+/**
+ * A B&B worker owns a relaxed / restricted pair, a node allocator and an open list.
+ * Workers run the classic best-first loop on their own open list and steal the best
+ * open node of a peer when they run dry. The primal bound and incumbent are shared
+ * through the `Bounds` instance.
+ */
+class BBWorker {
+   BBShared&                  _sh;
+   const unsigned             _id;
+   AbstractNodeAllocator::Ptr _bbPool;
+   AbstractDD::Ptr            _relaxed;
+   AbstractDD::Ptr            _restricted;
+   WidthBounded*              _ddr[2];
+   WidthControl*              _wc; // nullptr unless the widths are adaptive
+   OpenList                   _pq;
+   std::mutex                 _lock; // guards _pq and _returned against thieves
+   std::vector<ANode::Ptr>    _returned; // our nodes copied by a thief, released by our own thread
+   QNode                      _dive; // next node of the current plunge (node is nullptr when none)
+   double                     _inFlight; // bound of the node being expanded (when _busy)
+   bool                       _busy; // both guarded by _lock, or by the victim's lock while stealing
+   std::atomic<double>        _bound; // best of _pq, _dive and _inFlight, as of the last `publish`
+   unsigned                   _plunge; // expansions since the last restart from the best bound
+   bool next(QNode& bbn);
+   bool stealFrom(BBWorker* victim,QNode& bbn);
+   bool serviceLink(bool wait);
+   void plunge(const std::vector<std::pair<BBHeap::LocType*,ANode::Ptr>>& kids);
+   double openBound(double cur) const;
+   void publish() { // caller holds _lock (or steals for us: our open list is empty)
+      double b = _relaxed->initialBest();
+      if (!_pq.empty())
+         b = _relaxed->better(b,_pq.bestKey());
+      if (_dive.node)
+         b = _relaxed->better(b,_dive.bound);
+      if (_busy)
+         b = _relaxed->better(b,_inFlight);
+      _bound = b;
+   }
+   void hold(const QNode& q) { _inFlight = q.bound;_busy = true;publish();}
+   void donate(unsigned k);
+public:
+   BBWorker(BBShared& sh,unsigned id,AbstractDD::Ptr dd,const unsigned mxw,const unsigned rxw);
+   ~BBWorker();
+   void seed();
+   void run();
+   bool hasOpen() const noexcept { return !_pq.empty();}
+   unsigned nbOpen() const noexcept { return _pq.size();}
+   const OpenList& open() const noexcept { return _pq;}
+   std::size_t nbLive() const noexcept { return _bbPool->liveNodes();}
+   unsigned width() const noexcept { return _ddr[0]->getWidth();}
+   void setWidth(unsigned w) { _ddr[0]->setWidth(w);}
+   void recycle() { // caller holds _lock (or the workers are done)
+      for(auto n : _returned)
+         _bbPool->release(n);
+      _returned.clear();
+   }
+   void saveOpen(std::ostream& os) { _pq.save(os);}
+   void loadOpen(std::istream& is) {
+      auto key = readBin<double>(is);
+      _pq.insert(QNode { _bbPool->readNode(is),key });
+      publish();
+   }
+};
+
+BBWorker::BBWorker(BBShared& sh,unsigned id,AbstractDD::Ptr dd,const unsigned mxw,const unsigned rxw)
+   : _sh(sh),_id(id),
+     _bbPool(sh.workers.empty() ? dd->makeNDAllocator() : sh.workers[0]->_bbPool->share()), // one transposition table
+     _relaxed(dd->duplicate()),
+     _restricted(dd->duplicate()),
+     _pq(_bbPool,_relaxed.get(),sh.budget),
+     _dive { nullptr,0 },_inFlight(0),_busy(false),_bound(_relaxed->initialBest()),_plunge(0)
+{
+   auto rel = sh.refine ? new Refined(mxw) : new Relaxed(mxw);
+   rel->setCutSetType(sh.cutSet);
+   _relaxed->setStrategy(_ddr[0] = rel);
+   _restricted->setStrategy(_ddr[1] = new Restricted(rxw));
+   _ddr[0]->setEarlyStop(sh.domStop);
+   _ddr[1]->setEarlyStop(sh.domStop);
+   if (sh.nbCompile > 1) { // the two DDs are never compiled at the same time: one pool
+      auto tp = std::make_shared<TaskPool>(sh.nbCompile);
+      _relaxed->setTaskPool(tp);
+      _restricted->setTaskPool(tp);
+   }
+   _wc = sh.adaptive ? new WidthControl(_ddr[0],_ddr[1]) : nullptr;
+   if (id == 0)
+      _bbPool->setCapacity(sh.ttCap);
+   if (sh.budget && !_bbPool->canSerialize() && id == 0)
+      std::cerr << "B&B: no state serializer. Memory budget ignored.\n";
+}
+
+BBWorker::~BBWorker()
+{
+   delete _wc;
+   delete _ddr[0];
+   delete _ddr[1];
+}
+
+void BBWorker::seed()
+{
+   ANode::Ptr rootNode = _bbPool->cloneNode(_relaxed->init());
+   if (_relaxed->hasLocal()) {
+      auto dualRootValue = _relaxed->local(rootNode,LocalContext::BBCtx);
+      std::cout << "dual@root:" << dualRootValue << "\n";
       rootNode->setBackwardBound(dualRootValue);
-      pq.insertHeap(QNode { rootNode, dualRootValue } );   
+      _pq.insert(QNode { rootNode, dualRootValue } );
    } else {
-      pq.insertHeap(QNode { rootNode, relaxed->initialWorst() } );   
+      _pq.insert(QNode { rootNode, _relaxed->initialWorst() } );
+   }
+   publish();
+}
+
+bool BBWorker::stealFrom(BBWorker* victim,QNode& bbn)
+{
+   std::lock_guard<std::mutex> lock(victim->_lock);
+   if (!victim->_pq.canSteal())
+      return false;
+   _sh.nbIdle--; // leave the idle state *before* the victim can see an empty list
+   _sh.nbMoving++;
+   auto loot = victim->_pq.steal();
+   // The copy lives in our own allocator. The victim's allocator belongs to the victim's thread:
+   // the original goes back to the victim, who releases it in its next call to `next`.
+   bbn = QNode { _bbPool->copyNode(loot.node), loot.bound };
+   victim->_returned.push_back(loot.node);
+   hold(bbn);
+   victim->publish();
+   _sh.nbMoved++;
+   _sh.nbMoving--;
+   return true;
+}
+
+/**
+ * Talks to the coordinator: publishes an improved primal bound and the load, then handles the
+ * pending messages. With `wait`, the whole process is idle: it says so and blocks until it
+ * receives nodes or the search is over. Only one worker at a time services the link.
+ * @return true if nodes were added to our open list.
+ */
+bool BBWorker::serviceLink(bool wait)
+{
+   std::unique_lock<std::mutex> lk(_sh.linkMtx,std::try_to_lock);
+   if (!lk.owns_lock())
+      return false;
+   auto& ch = *_sh.link;
+   Bounds& bnds = _sh.bnds;
+   {
+      std::lock_guard<Bounds> lock(bnds);
+      if (_relaxed->isBetter(bnds.getPrimal(),_sh.sentPrimal)) {
+         _sh.sentPrimal = bnds.getPrimal();
+         ch.send((std::uint8_t)BBMsg::Primal,encodePrimal(_sh.sentPrimal,bnds.getIncumbent()));
+      }
+   }
+   const auto now = RuntimeMonitor::cputime();
+   if (wait)
+      ch.send((std::uint8_t)BBMsg::Idle,"");
+   else if (RuntimeMonitor::elapsedMilliseconds(_sh.lastStatus,now) > 50) {
+      unsigned nbOpen = 0;
+      for(auto w : _sh.workers) {
+         std::lock_guard<std::mutex> lock(w->_lock);
+         nbOpen += w->_pq.size();
+      }
+      ch.send((std::uint8_t)BBMsg::Status,encodeCount(nbOpen));
+      _sh.lastStatus = now;
    }
-   unsigned nNode = 0,ttlNode = 0,insDom=0,pruned=0;
+   bool got = false;
+   do {
+      while (!_sh.stop && ch.ready(wait ? 100 : 0)) {
+         std::uint8_t tag;
+         std::string msg;
+         if (!ch.recv(tag,msg)) {
+            std::cerr << "B&B: lost the coordinator\n";
+            _sh.halt();
+            break;
+         }
+         switch((BBMsg)tag) {
+            case BBMsg::Primal: {
+               double v;
+               std::vector<int> inc;
+               decodePrimal(msg,v,inc);
+               std::lock_guard<Bounds> lock(bnds);
+               if (_relaxed->isBetter(v,bnds.getPrimal())) {
+                  bnds.setPrimal(v);
+                  bnds.setIncumbent(inc.begin(),inc.end());
+               }
+               if (_relaxed->isBetter(v,_sh.sentPrimal))
+                  _sh.sentPrimal = v; // no echo
+            }break;
+            case BBMsg::Nodes: {
+               auto batch = decodeNodes(msg);
+               std::lock_guard<std::mutex> lock(_lock);
+               for(const auto& b : batch) {
+                  std::istringstream is(b.node);
+                  _pq.insert(QNode { _bbPool->readNode(is), b.key });
+               }
+               publish();
+               got = got || !batch.empty();
+            }break;
+            case BBMsg::Donate: donate(decodeCount(msg));break;
+            case BBMsg::Stop:
+               _sh.done = true;
+               _sh.halt();
+               break;
+            default: break;
+         }
+         if (got)
+            break;
+      }
+   } while (wait && !got && !_sh.stop && !_sh.ckPending);
+   return got;
+}
+
+/**
+ * Sends up to `k` open nodes to the coordinator, at most half of the resident nodes of each
+ * worker of this process, ours first. Nodes of a peer go back to its return list (see `stealFrom`).
+ */
+void BBWorker::donate(unsigned k)
+{
+   std::vector<BBBlob> batch;
+   const auto nbw = (unsigned)_sh.workers.size();
+   for(auto i = 0u;i < nbw && batch.size() < k;i++) {
+      auto w = _sh.workers[(_id + i) % nbw];
+      std::lock_guard<std::mutex> lock(w->_lock);
+      for(auto nb = (w->_pq.size() + 1) / 2;nb > 0 && batch.size() < k && w->_pq.canSteal();--nb) {
+         auto q = w->_pq.steal();
+         std::ostringstream os;
+         w->_bbPool->writeNode(os,q.node);
+         batch.push_back(BBBlob { q.bound, os.str() });
+         if (w == this)
+            _bbPool->release(q.node);
+         else w->_returned.push_back(q.node);
+      }
+      w->publish();
+   }
+   _sh.link->send((std::uint8_t)BBMsg::Nodes,encodeNodes(batch));
+}
+
+bool BBWorker::next(QNode& bbn)
+{
+   {
+      std::lock_guard<std::mutex> lock(_lock);
+      recycle();
+   }
+   if (_sh.link)
+      serviceLink(false);
+   _sh.checkpointIfDue();
+   if (_dive.node) { // keep plunging unless a checkpoint needs the node in the open list
+      std::lock_guard<std::mutex> lock(_lock);
+      if (!_sh.ckPending) {
+         bbn = _dive;
+         _dive.node = nullptr;
+         hold(bbn);
+         return true;
+      }
+      _pq.insert(_dive);
+      _dive.node = nullptr;
+   }
+   _plunge = 0;
+   if (_sh.ckPending && !_sh.stop)
+      _sh.park();
+   {
+      std::lock_guard<std::mutex> lock(_lock);
+      if (!_pq.empty()) {
+         bbn = _pq.extract();
+         hold(bbn);
+         return true;
+      }
+      _busy = false;
+      publish();
+      _sh.nbIdle++; // done under our lock so that a thief sees a consistent state
+   }
+   const auto nbw = (unsigned)_sh.workers.size();
+   while (!_sh.stop) {
+      if (_sh.nbIdle == nbw) {
+         if (!_sh.link)
+            return false;
+         if (serviceLink(true)) { // the coordinator sent us work
+            std::lock_guard<std::mutex> lock(_lock);
+            if (!_pq.empty()) {
+               _sh.nbIdle--;
+               bbn = _pq.extract();
+               hold(bbn);
+               return true;
+            }
+         } else std::this_thread::yield();
+         continue;
+      }
+      if (_sh.ckPending)
+         _sh.park();
+      for(auto k = 1u;k < nbw;k++)
+         if (stealFrom(_sh.workers[(_id + k) % nbw],bbn))
+            return true;
+      std::this_thread::yield();
+   }
+   return false;
+}
+
+void BBWorker::run()
+{
+   using namespace std;
+   Bounds& bnds = _sh.bnds;
+   AbstractDD::Ptr relaxed = _relaxed,restricted = _restricted;
    bool primalBetter = false;
-   cout << "B&B Nodes          " << setw(6) << "Dual\t " << setw(6) << "Primal\t Gap(%)\n";
-   cout << "----------------------------------------------\n";
-   while(!pq.empty()) {
+   QNode bbn;
+   while(!_sh.stop && next(bbn)) {
 
        // cout << "----------------------------------------------------------------------" << "\n";
        // cout << "B&B HEAP\n";
@@ -66,29 +686,37 @@ void BAndB::search(Bounds& bnds)
        //    return os;
        // }) << "\n";
        // cout << "----------------------------------------------------------------------" << "\n";
-      
-      auto bbn = pq.extractMax();
+
       auto curDual = bbn.bound;
-      bnds.setDual(bbn.node->getBound(),curDual);
       auto now = RuntimeMonitor::cputime();
-      auto fs = RuntimeMonitor::elapsedMilliseconds(start,now);
-      auto fl = RuntimeMonitor::elapsedMilliseconds(last,now);
-      if (_timeLimit && _timeLimit(fs))         
-         break;      
-      if (primalBetter || fl > 5000) {
-         double gap = 100 * std::abs(bnds.getPrimal() - curDual) / bnds.getPrimal();      
-         cout << std::fixed << "B&B(" << setw(5) << nNode << ")\t " << setprecision(6);
-         if (curDual == relaxed->initialWorst())
-            cout << setw(7) << "-"  << "\t " << setw(7) << bnds.getPrimal() << "\t ";
-         else
-            cout << setw(7) << curDual << "\t " << setw(7) << bnds.getPrimal() << "\t ";
-         if (gap > 100)
-            cout << setw(6) << "-";
-         else cout << setw(6) << setprecision(4) << gap << "%";
-         cout << "\t time:" << setw(6) << setprecision(4) <<  fs / 1000.0 << "s";
-         cout << "\n";
-         last = RuntimeMonitor::cputime();
-     }
+      auto fs = RuntimeMonitor::elapsedMilliseconds(_sh.start,now);
+      if (_sh.timeLimit && _sh.timeLimit(fs)) {
+         std::lock_guard<std::mutex> lock(_lock);
+         _pq.insert(bbn); // still open: keep it for the final checkpoint
+         publish();
+         _sh.halt();
+         break;
+      }
+      const auto dual = openBound(curDual); // a plunge or a peer may hold better open nodes
+      {
+         std::lock_guard<Bounds> lock(bnds); // the bounds lock also serializes the output
+         bnds.setDual(bbn.node->getBound(),dual);
+         auto fl = RuntimeMonitor::elapsedMilliseconds(_sh.last,now);
+         if (primalBetter || fl > 5000) {
+            double gap = 100 * std::abs(bnds.getPrimal() - dual) / bnds.getPrimal();
+            cout << std::fixed << "B&B(" << setw(5) << _sh.nNode << ")\t " << setprecision(6);
+            if (dual == relaxed->initialWorst())
+               cout << setw(7) << "-"  << "\t " << setw(7) << bnds.getPrimal() << "\t ";
+            else
+               cout << setw(7) << dual << "\t " << setw(7) << bnds.getPrimal() << "\t ";
+            if (gap > 100)
+               cout << setw(6) << "-";
+            else cout << setw(6) << setprecision(4) << gap << "%";
+            cout << "\t time:" << setw(6) << setprecision(4) <<  fs / 1000.0 << "s";
+            cout << "\n";
+            _sh.last = RuntimeMonitor::cputime();
+         }
+      }
       auto compDual = bbn.node->getBound() + relaxed->local(bbn.node,LocalContext::DDInit);
       //cout << "DUAL KEY:" << curDual << " dualCOMP:" << compDual << "\n";
       if (!relaxed->isBetterEQ(compDual,curDual)) {
@@ -97,39 +725,50 @@ void BAndB::search(Bounds& bnds)
       }
       primalBetter = false;
 #ifndef _NDEBUG
-      cout << "BOUNDS NOW: " << bnds << endl; 
+      cout << "BOUNDS NOW: " << bnds << endl;
       cout << "EXTRACTED:  " << bbn.node->getId() << " ::: ";
       relaxed->printNode(cout,bbn.node);
-      cout << "\t(" << curDual << ")" << " SZ:" << pq.size() << endl;
+      cout << "\t(" << curDual << ")" << " SZ:" << _pq.size() << endl;
 #endif
-      ttlNode++;
+      _sh.ttlNode++;
+      if (_bbPool->superseded(bbn.node)) { // same state was queued later with a better bound
+         _sh.nbSeen++;
+         _bbPool->release(bbn.node);
+         continue;
+      }
       // cout << "CURDUAL:" << curDual << "\t PRIMAL:" << bnds.getPrimal()
       //      << " isBetter:" << relaxed->isBetter(curDual,bnds.getPrimal()) << "\n";
       if (!relaxed->isBetter(curDual,bnds.getPrimal())) {
-         bbPool->release(bbn.node);
+         _bbPool->release(bbn.node);
          continue;
       }
-      nNode++;
+      _sh.nNode++;
       //cout << "relaxed->apply: " << bbn.node->getBound() << "\n";
+      const auto cStart = RuntimeMonitor::now();
       bool dualBetter = relaxed->apply(bbn.node,bnds);
+      const auto cTime = RuntimeMonitor::elapsedSinceMicro(cStart);
+      std::size_t cutSize = 0;
 #ifndef _NDEBUG
       cout << "relaxed ran..." << "\n";
-      relaxed->printNode(cout,bbn.node);      
+      relaxed->printNode(cout,bbn.node);
 #endif
       //cout << "dualBetter? " << dualBetter << "\n";
       if (dualBetter) {
          primalBetter = restricted->apply(bbn.node,bnds);
-         
+
          if (!restricted->isExact() && !relaxed->isExact()) {
-            auto cutSet = relaxed->computeCutSet();
+            std::vector<std::pair<BBHeap::LocType*,ANode::Ptr>> kids; // queued nodes the policy may plunge into
+            auto cutSet = relaxed->computeCutSet(bnds);
+            cutSize = cutSet.size();
             //int k = 0;
             for(auto n : cutSet) {
                //std::cout << "CUTSET(" << k++ << ") ";
                //relaxed->printNode(std::cout,n);
-               
+
                if (n == relaxed->getRoot()) { // the cutset is the root. Only way out: increase width.
-                  auto w = ddr[0]->getWidth() + 1;
-                  ddr[0]->setWidth(w);
+                  auto w = _ddr[0]->getWidth() + 1;
+                  _ddr[0]->setWidth(w);
+                  std::lock_guard<Bounds> lock(bnds);
                   std::cout << "\t-->widening... " << w << " CUTSET SIZE:" << cutSet.size() <<  "\n";
                }
                // use the bound in n (the ones in nd are _reset_ when duplicate occurs????)
@@ -140,68 +779,372 @@ void BAndB::search(Bounds& bnds)
                   // std::cout << "\n";
                   continue; // the loop over the cutset! Not the main loop
                }
-               if (relaxed->hasDominance()) {
+               std::lock_guard<std::mutex> lock(_lock);
+               if (_sh.useDom && relaxed->hasDominance()) {
                   unsigned d = 0;
-                  auto pqSz = pq.size();
-                  auto allLocs = new Heap<QNode,decltype(hOrder)>::LocType*[pqSz];
-                  for(unsigned k = 0;k < pqSz;k++) {
-                     auto bbn = pq[k];
-                     bool isObjDom   = relaxed->isBetterEQ(bbn->value().node->getBound(),n->getBound());
-                     newGuyDominated = isObjDom && relaxed->dominates(bbn->value().node,n);
-                     if (newGuyDominated)
-                        break;                     
-                     bool objDom   = relaxed->isBetterEQ(n->getBound(),bbn->value().node->getBound());
-                     bool qnDominated = objDom && relaxed->dominates(n,bbn->value().node);
-                     if (qnDominated)
-                        allLocs[d++] = bbn;
-                  }
-                  if (d) {
-                     //std::cout << "new BBNode Dominated " << d << " BB nodes" << std::endl;
-                     for(auto i =0u; i < d;i++) 
-                        pq.remove(allLocs[i]);
-                     pruned += d;
-                  }
-                  delete[]allLocs;
+                  newGuyDominated = _pq.dominated(n,d);
+                  _sh.pruned += d;
                }
                assert(n->isExact());
                //std::cout << "new guy: " << newGuyDominated << "\n";
                if (!newGuyDominated) {
-                  auto nd = bbPool->cloneNode(n);                  
-                  //std::cout << "CLONED and got:"  << nd << "\n";                 
-                  if (nd) { // the node creation could return *NOTHING* if it was already created
-                     assert(nd->getBound() == n->getBound());
-                     double bwd;
-                     if (relaxed->hasLocal()) {
-                        auto newBnd = relaxed->local(nd,LocalContext::BBCtx);
-                        // if (newBnd > n->getBackwardBound())                           
-                        //std::cout<<"New:"<< newBnd << " backward:" << n->getBackwardBound() << "\n";
-                        //if (newBnd <= n->getBackwardBound())
-                        if (!relaxed->isBetter(newBnd,n->getBackwardBound()))
-                           bwd = newBnd;
-                        else bwd = n->getBackwardBound();
-                        //bwd = n->getBackwardBound();
-                     } else bwd = n->getBackwardBound();                     
-                     const auto insKey = n->getBound() + bwd;
-                     const auto improve = relaxed->isBetter(insKey,bnds.getPrimal());
-                     //std::cout<< "CLONE VALUE:" << insKey << " bwd:" << bwd << " PRIMAL:" << bnds.getPrimal()
-                     //<< " IMPROVED:" << (improve ? "T" : "F") << "\n";
-                     if (improve) 
-                        pq.insertHeap(QNode {nd, insKey }); //std::min(insKey,curDual)});
-                  } else nbSeen++;
-               }
-               else insDom++;
+                  // The root must be re-queued as is (wider). Others go through the transposition table.
+                  auto nd = (n == relaxed->getRoot()) ? _bbPool->copyNode(n) : _bbPool->cloneNode(n);
+                  //std::cout << "CLONED and got:"  << nd << "\n";
+                  if (!nd) { // the node creation returns *NOTHING* if the state was already queued with a better bound
+                     _sh.nbSeen++;
+                     continue;
+                  }
+                  assert(nd->getBound() == n->getBound());
+                  double bwd;
+                  if (relaxed->hasLocal()) {
+                     auto newBnd = relaxed->local(nd,LocalContext::BBCtx);
+                     // if (newBnd > n->getBackwardBound())
+                     //std::cout<<"New:"<< newBnd << " backward:" << n->getBackwardBound() << "\n";
+                     //if (newBnd <= n->getBackwardBound())
+                     if (!relaxed->isBetter(newBnd,n->getBackwardBound()))
+                        bwd = newBnd;
+                     else bwd = n->getBackwardBound();
+                     //bwd = n->getBackwardBound();
+                  } else bwd = n->getBackwardBound();
+                  const auto insKey = n->getBound() + bwd;
+                  const auto improve = relaxed->isBetter(insKey,bnds.getPrimal());
+                  //std::cout<< "CLONE VALUE:" << insKey << " bwd:" << bwd << " PRIMAL:" << bnds.getPrimal()
+                  //<< " IMPROVED:" << (improve ? "T" : "F") << "\n";
+                  if (!improve)
+                     _bbPool->release(nd);
+                  else {
+                     auto loc = _pq.insert(QNode {nd, insKey }); //std::min(insKey,curDual)});
+                     publish();
+                     if (_sh.sel)
+                        kids.emplace_back(loc,nd);
+                  }
+               } else _sh.insDom++;
             }
+            if (!kids.empty())
+               plunge(kids);
          }
-      } //else 
-      //std::cout << "DB:F " <<  "Primal:" << bnds.getPrimal() << " Dual:" << relaxed->currentOpt()  << "\n";      
-      bbPool->release(bbn.node);
+      } //else
+      //std::cout << "DB:F " <<  "Primal:" << bnds.getPrimal() << " Dual:" << relaxed->currentOpt()  << "\n";
+      if (_wc) {
+         const auto p = bnds.getPrimal();
+         const double gap = (p == relaxed->initialBest() || p == 0) ? -1 : std::abs(p - dual) / std::abs(p);
+         if (_wc->record(cTime,cutSize,primalBetter,gap)) {
+            std::lock_guard<Bounds> lock(bnds);
+            std::cout << "\t-->widths... " << _ddr[0]->getWidth() << "/" << _ddr[1]->getWidth() << "\n";
+         }
+      }
+      _bbPool->release(bbn.node);
+   }
+   if (_dive.node) { // stopped in the middle of a plunge: the node is still open
+      std::lock_guard<std::mutex> lock(_lock);
+      _pq.insert(_dive);
+      _dive.node = nullptr;
+   }
+}
+
+/**
+ * Lets the node selection policy pick the next node among the `kids` of the last expansion.
+ * The kids are already queued (and took part in dominance checks): the chosen one, if still open,
+ * leaves the open list and is expanded next.
+ */
+void BBWorker::plunge(const std::vector<std::pair<BBHeap::LocType*,ANode::Ptr>>& kids)
+{
+   std::lock_guard<std::mutex> lock(_lock);
+   std::vector<BBHeap::LocType*> open;
+   std::vector<BBCandidate> cands;
+   for(const auto& [l,n] : kids)
+      if (_pq.holds(l,n) && std::find(open.begin(),open.end(),l) == open.end()) { // not dominated, spilled or recycled
+         open.push_back(l);
+         cands.push_back(BBCandidate { l->value().bound,(unsigned)n->depth() });
+      }
+   if (open.empty())
+      return;
+   const int k = _sh.sel->select(_relaxed.get(),cands,_plunge,_pq.bestKey(),_sh.bnds.getPrimal());
+   if (k >= 0) {
+      _dive = _pq.take(open[k]);
+      publish();
+      ++_plunge;
+   }
+}
+
+/**
+ * Best bound among the open nodes of every worker, counting the nodes being expanded and the next
+ * nodes of the plunges: a valid dual bound. Each worker publishes its own part (`publish`) after
+ * every change, under its lock, so no lock is taken here. Only a steal moves a node between two
+ * workers: the reads are retried when one overlapped them, since they could miss the stolen node.
+ */
+double BBWorker::openBound(double cur) const
+{
+   for(;;) {
+      const unsigned moved = _sh.nbMoved;
+      if (_sh.nbMoving == 0) {
+         double b = cur;
+         for(auto w : _sh.workers)
+            b = _relaxed->better(b,w->_bound);
+         if (_sh.nbMoving == 0 && _sh.nbMoved == moved)
+            return b;
+      }
+      std::this_thread::yield();
+   }
+}
+
+int DepthFirst::select(AbstractDD* dd,const std::vector<BBCandidate>& kids,unsigned plunge,double best,double primal) const
+{
+   if (plunge >= _maxPlunge)
+      return -1;
+   int k = 0;
+   for(auto i = 1u;i < kids.size();i++)
+      if (kids[i].depth > kids[k].depth || (kids[i].depth == kids[k].depth && dd->isBetter(kids[i].key,kids[k].key)))
+         k = i;
+   return k;
+}
+
+int BestEstimate::select(AbstractDD* dd,const std::vector<BBCandidate>& kids,unsigned plunge,double best,double primal) const
+{
+   int k = 0;
+   for(auto i = 1u;i < kids.size();i++)
+      if (dd->isBetter(kids[i].key,kids[k].key))
+         k = i;
+   if (primal == dd->initialBest()) // no incumbent yet: dive for one
+      return plunge < _maxPlunge ? k : -1;
+   const double limit = best + _quota * (primal - best);
+   return dd->isBetterEQ(kids[k].key,limit) ? k : -1;
+}
+
+static const char ckMagic[8] = {'D','D','O','P','T','C','K','1'};
+
+void BBShared::checkpointIfDue()
+{
+   if (ckFile.empty() || ckPending)
+      return;
+   if (RuntimeMonitor::elapsedMilliseconds(ckLast,RuntimeMonitor::cputime()) >= ckPeriod)
+      ckPending = true;
+}
+
+/**
+ * Checkpoint barrier. The last worker to park writes the checkpoint and releases the others.
+ * Nobody parks (or stays parked) once the search is stopped: the final checkpoint is then
+ * taken after the workers are done.
+ */
+void BBShared::park()
+{
+   std::unique_lock<std::mutex> lk(ckMtx);
+   if (stop || !ckPending)
+      return;
+   const auto gen = ckGen;
+   if (++nbParked == workers.size()) {
+      saveCheckpoint();
+      nbParked = 0;
+      ckLast = RuntimeMonitor::cputime();
+      ckPending = false;
+      ++ckGen;
+      ckCV.notify_all();
+   } else
+      ckCV.wait(lk,[this,gen] { return gen != ckGen || stop;});
+}
+
+/**
+ * Layout: magic, primal, primal set, g, dual, incumbent (size + labels), relaxed width,
+ * node counters, number of open nodes and the open nodes (key + node, see `writeNode`).
+ * The file is written aside and renamed so that a preempted write leaves the previous checkpoint intact.
+ */
+void BBShared::saveCheckpoint()
+{
+   std::lock_guard<Bounds> lock(bnds);
+   const auto tmp = ckFile + ".tmp";
+   std::ofstream os(tmp,std::ios::binary | std::ios::trunc);
+   os.write(ckMagic,sizeof(ckMagic));
+   writeBin(os,bnds.getPrimal());
+   writeBin(os,bnds.hasPrimal());
+   writeBin(os,bnds.getG());
+   writeBin(os,bnds.getDual());
+   const auto& inc = bnds.getIncumbent();
+   writeBin(os,(unsigned)inc.size());
+   for(auto l : inc)
+      writeBin(os,l);
+   unsigned width = 0;
+   std::size_t nbOpen = 0;
+   for(auto w : workers) {
+      width = std::max(width,w->width());
+      nbOpen += w->nbOpen();
+   }
+   writeBin(os,width);
+   for(unsigned v : {nNode.load(),ttlNode.load(),insDom.load(),pruned.load(),nbSeen.load()})
+      writeBin(os,v);
+   writeBin(os,nbOpen);
+   for(auto w : workers)
+      w->saveOpen(os);
+   os.close();
+   if (!os) {
+      std::cerr << "B&B: could not write checkpoint " << tmp << "\n";
+      return;
+   }
+   std::filesystem::rename(tmp,ckFile);
+   std::cout << "\t-->checkpoint " << ckFile << " (" << nbOpen << " open nodes)\n";
+}
+
+/**
+ * Restores the bounds, the incumbent, the statistics and the open nodes (dealt round robin to the workers).
+ */
+bool BBShared::loadCheckpoint(std::istream& is)
+{
+   char magic[sizeof(ckMagic)];
+   is.read(magic,sizeof(magic));
+   if (!is || !std::equal(magic,magic + sizeof(magic),ckMagic)) {
+      std::cerr << "B&B: not a checkpoint file\n";
+      return false;
+   }
+   const auto primal = readBin<double>(is);
+   if (readBin<bool>(is))
+      bnds.setPrimal(primal);
+   const auto g = readBin<double>(is);
+   bnds.setDual(g,readBin<double>(is));
+   std::vector<int> inc(readBin<unsigned>(is));
+   for(auto& l : inc)
+      l = readBin<int>(is);
+   if (!inc.empty())
+      bnds.setIncumbent(inc.begin(),inc.end());
+   const auto width = readBin<unsigned>(is);
+   for(auto w : workers)
+      w->setWidth(std::max(width,w->width()));
+   for(auto* c : {&nNode,&ttlNode,&insDom,&pruned,&nbSeen})
+      *c = readBin<unsigned>(is);
+   const auto nbOpen = readBin<std::size_t>(is);
+   for(auto i = 0u;i < nbOpen && is;i++)
+      workers[i % workers.size()]->loadOpen(is);
+   if (!is) {
+      std::cerr << "B&B: truncated checkpoint\n";
+      return false;
+   }
+   std::cout << "B&B resuming from " << nbOpen << " open nodes. " << bnds << "\n";
+   return true;
+}
+
+bool BAndB::explore(Bounds& bnds,std::istream* ck)
+{
+   using namespace std;
+   BBShared sh(bnds,_timeLimit,_ttCap,_budget ? std::max<std::size_t>(1,_budget / _nbw) : 0);
+   sh.ckFile   = _ckFile;
+   sh.ckPeriod = _ckPeriod * 1000;
+   sh.useDom   = _dom;
+   sh.domStop  = _domStop;
+   sh.adaptive = _adaptive;
+   sh.sel      = _sel;
+   sh.cutSet   = _cutSet;
+   sh.refine   = _refine;
+   sh.nbCompile = _nbCompile;
+   _proved = false;
+   std::streamsize ss;
+   {
+      std::lock_guard<Bounds> lock(bnds); // the output is shared with concurrent searches (portfolio)
+      ss = cout.precision();
+      cout << "B&B searching..." << endl;
+   }
+   for(auto i = 0u;i < _nbw;i++)
+      sh.workers.push_back(new BBWorker(sh,i,_theDD,_mxw,_rxw ? _rxw : _mxw));
+   const auto release = [&sh]() {
+      for(auto w : sh.workers)
+         delete w;
+   };
+   if (ck && !sh.loadCheckpoint(*ck)) {
+      release();
+      return false;
    }
+   unsigned rank = 0;
+   if (!_remote.empty()) {
+      std::uint8_t tag;
+      std::string msg;
+      sh.link = Channel::connect(_remote);
+      if (!sh.link || !sh.link->recv(tag,msg) || (BBMsg)tag != BBMsg::Start) {
+         std::cerr << "B&B: no coordinator at " << _remote << "\n";
+         release();
+         return false;
+      }
+      rank = decodeCount(msg);
+      cout << "B&B process " << rank << " connected to " << _remote << "\n";
+   }
+   bnds.attach(_theDD);
+   sh.sentPrimal = bnds.getPrimal();
+   double optTime = 0.0;
+   auto onSol = bnds.onSolution([ss,start = sh.start,&optTime](const auto& lbls) {
+      optTime = RuntimeMonitor::elapsedSince(start);
+      std::cout << "TIME:" << setprecision(ss) << optTime << "\n";
+   });
+   if (!ck && rank == 0)
+      sh.workers[0]->seed();
+   {
+      std::lock_guard<Bounds> lock(bnds);
+      cout << "B&B Nodes          " << setw(6) << "Dual\t " << setw(6) << "Primal\t Gap(%)\n";
+      cout << "----------------------------------------------\n";
+   }
+   if (_nbw == 1)
+      sh.workers[0]->run();
+   else {
+      std::vector<std::thread> threads;
+      for(auto w : sh.workers)
+         threads.emplace_back([w]() { w->run();});
+      for(auto& t : threads)
+         t.join();
+   }
+   _nbLive = 0;
+   for(auto w : sh.workers) { // nodes stolen after their owner went idle
+      w->recycle();
+      _nbLive += w->nbLive();
+   }
+   bool open = sh.stop && !sh.done;
+   for(auto w : sh.workers)
+      open = open || w->hasOpen();
+   bnds.offSolution(onSol);
+   _proved = !open;
+   if (!sh.ckFile.empty())
+      sh.saveCheckpoint(); // final state: resuming a completed search ends at once
+   _nbRuns = _nbRestores = 0;
+   for(auto w : sh.workers) {
+      _nbRuns     += w->open().nbRuns();
+      _nbRestores += w->open().nbRestores();
+   }
+   release();
+   std::lock_guard<Bounds> lock(bnds);
    cout << setprecision(ss);
-   auto spent = RuntimeMonitor::elapsedSince(start);
-   cout << "Done(" << _mxw << "):" << bnds.getPrimal() << "\t #nodes:" <<  nNode << "/" << ttlNode
-        << "\t P/D:" << pruned << "/" << insDom
+   auto spent = RuntimeMonitor::elapsedSince(sh.start);
+   cout << "Done(" << _mxw << "):" << bnds.getPrimal() << "\t #nodes:" <<  sh.nNode << "/" << sh.ttlNode
+        << "\t P/D:" << sh.pruned << "/" << sh.insDom
         << "\t Time:" << optTime/1000 << "/" << spent/1000 << "s"
-        << "\t LIM?:" << (pq.size() > 0)
-        << "\t Seen:" << nbSeen
-        << "\n";
+        << "\t LIM?:" << open
+        << "\t Seen:" << sh.nbSeen;
+   if (_budget)
+      cout << "\t Spills:" << _nbRuns << "/" << _nbRestores;
+   _theDD->printCaches(cout);
+   cout << "\n";
+   return true;
+}
+
+void BAndB::search(Bounds& bnds)
+{
+   explore(bnds,nullptr);
+}
+
+bool BAndB::resume(Bounds& bnds,const std::string& fName)
+{
+   if (!_theDD->hasSerializer()) {
+      std::cerr << "B&B: no state serializer. Cannot resume from " << fName << "\n";
+      return false;
+   }
+   std::ifstream is(fName,std::ios::binary);
+   if (!is) {
+      std::cerr << "B&B: cannot open checkpoint " << fName << "\n";
+      return false;
+   }
+   return explore(bnds,&is);
+}
+
+void BAndB::setCheckpoint(const std::string& fName,double period)
+{
+   if (!_theDD->hasSerializer()) {
+      std::cerr << "B&B: no state serializer. Checkpoints disabled.\n";
+      return;
+   }
+   _ckFile = fName;
+   _ckPeriod = period;
 }
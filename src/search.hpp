@@ -2,19 +2,222 @@
 #define __SEARCH_HPP__
 
 #include <functional>
+#include <string>
+#include <iostream>
+#include <algorithm>
 #include "dd.hpp"
 #include "store.hpp"
 
+/**
+ * An open node created by the last expansion, as seen by a node selection policy.
+ */
+struct BBCandidate {
+   double   key;   // bound of the node in the open list
+   unsigned depth; // number of decisions from the root (see `ANode::depth`)
+};
+
+/**
+ * @brief Node selection policy of the B&B.
+ * The open list is always ordered by bound. After each expansion, a policy may *plunge* into one
+ * of the new nodes instead of returning to the best bound node. The other new nodes are queued.
+ * Policies are stateless and shared by the workers.
+ */
+class NodeSelection {
+public:
+   typedef std::shared_ptr<NodeSelection> Ptr;
+   virtual ~NodeSelection() {}
+   virtual const std::string getName() const = 0;
+   /**
+    * @param dd     the model (direction of the objective)
+    * @param kids   the nodes created by the last expansion
+    * @param plunge number of consecutive plunges so far
+    * @param best   best bound among the open nodes and the kids
+    * @param primal current primal bound
+    * @return the index of the kid to expand next or -1 to restart from the best bound node.
+    */
+   virtual int select(AbstractDD* dd,const std::vector<BBCandidate>& kids,unsigned plunge,double best,double primal) const = 0;
+};
+
+/**
+ * Best bound first (the default). Never plunges.
+ */
+class BestFirst :public NodeSelection {
+public:
+   const std::string getName() const { return "BestFirst";}
+   int select(AbstractDD*,const std::vector<BBCandidate>&,unsigned,double,double) const { return -1;}
+};
+
+/**
+ * Depth-first plunging: expands the deepest kid (best bound among equals) and restarts from the best
+ * bound node once a plunge reaches `maxPlunge` expansions or runs out of kids.
+ */
+class DepthFirst :public NodeSelection {
+   unsigned _maxPlunge;
+public:
+   DepthFirst(unsigned maxPlunge = 32) : _maxPlunge(maxPlunge) {}
+   const std::string getName() const { return "DepthFirst";}
+   int select(AbstractDD* dd,const std::vector<BBCandidate>& kids,unsigned plunge,double best,double primal) const;
+};
+
+/**
+ * Best-estimate hybrid: plunges into the kid with the best bound (our estimate of the best solution below
+ * it) as long as that bound lies within `quota` of the gap from the best bound. Without a primal
+ * bound, it plunges up to `maxPlunge` expansions to find one early.
+ */
+class BestEstimate :public NodeSelection {
+   double   _quota;
+   unsigned _maxPlunge;
+public:
+   BestEstimate(double quota = 0.25,unsigned maxPlunge = 32) : _quota(quota),_maxPlunge(maxPlunge) {}
+   const std::string getName() const { return "BestEstimate";}
+   int select(AbstractDD* dd,const std::vector<BBCandidate>& kids,unsigned plunge,double best,double primal) const;
+};
+
+/**
+ * Tunes the widths of the relaxed and restricted DDs of a worker, one window of B&B nodes at a time.
+ *  - The restricted width doubles when the primal bound did not improve during the window.
+ *  - The relaxed width shrinks when nodes are cheap but numerous (fast compilations, large cutsets)
+ *    and grows when the gap barely closed during the window.
+ * Each width stays within [w/4,8w] of its initial value w.
+ */
+class WidthControl {
+   static constexpr unsigned    window   = 64;     // nodes between decisions
+   static constexpr double      cheap    = 1000;   // microseconds for a relaxed compilation
+   static constexpr std::size_t numerous = 8;      // cutset size
+   static constexpr double      closing  = 0.01;   // relative gap closure expected per window
+   WidthBounded* _ddr[2]; // relaxed, restricted
+   unsigned      _lo[2],_hi[2];
+   unsigned      _nb;
+   double        _time;
+   std::size_t   _cut;
+   bool          _improved;
+   double        _gap0;
+   void resize(unsigned k,unsigned w) {
+      _hi[k] = std::max(_hi[k],_ddr[k]->getWidth()); // the root may have been widened beyond
+      _ddr[k]->setWidth(std::clamp(w,_lo[k],_hi[k]));
+   }
+public:
+   WidthControl(WidthBounded* rel,WidthBounded* res) : _ddr{rel,res},_nb(0),_time(0),_cut(0),_improved(false),_gap0(-1) {
+      for(auto k = 0u;k < 2;k++) {
+         _lo[k] = std::max(1u,_ddr[k]->getWidth() / 4);
+         _hi[k] = _ddr[k]->getWidth() * 8;
+      }
+   }
+   /**
+    * Accounts for one B&B node: compilation time of its relaxed DD (microseconds), size of its cutset,
+    * whether it improved the primal and the relative gap after it (negative when unknown).
+    * @return true when a width changed.
+    */
+   bool record(double us,std::size_t cutSize,bool primalBetter,double gap) {
+      if (_gap0 < 0)
+         _gap0 = gap;
+      _time += us;
+      _cut  += cutSize;
+      _improved = _improved || primalBetter;
+      if (++_nb < window)
+         return false;
+      const unsigned w[2] = { _ddr[0]->getWidth(),_ddr[1]->getWidth() };
+      if (!_improved)
+         resize(1,w[1] * 2);
+      if (_time / _nb < cheap && _cut / _nb >= numerous)
+         resize(0,w[0] * 3 / 4);
+      else if (_gap0 > 0 && gap >= 0 && (_gap0 - gap) / _gap0 < closing)
+         resize(0,w[0] + std::max(1u,w[0] / 2));
+      _nb = 0;
+      _time = 0;
+      _cut = 0;
+      _improved = false;
+      _gap0 = gap;
+      return w[0] != _ddr[0]->getWidth() || w[1] != _ddr[1]->getWidth();
+   }
+};
+
 class BAndB {
    AbstractDD::Ptr _theDD;
    const unsigned    _mxw;
+   unsigned          _rxw; // width of the restricted DDs (0 = _mxw)
+   bool              _dom; // dominance checks on the open list
+   bool              _domStop; // bounded in-layer dominance scans (see `WidthBounded::setEarlyStop`)
+   bool              _adaptive; // widths tuned during the search
+   bool              _proved; // the last search closed the gap (not stopped by its time limit)
+   NodeSelection::Ptr _sel; // node selection policy (nullptr = best first)
+   CutSetType        _cutSet;
+   bool              _refine; // relaxed DDs by incremental refinement (see `Refined`)
+   unsigned          _nbCompile; // threads per worker expanding DD layers
+   unsigned          _nbw; // number of workers (threads) used by the search
+   std::size_t       _ttCap; // entries in the transposition table shared by the workers (0 = unbounded)
+   std::size_t       _budget; // bytes of B&B node storage (0 = unbounded)
+   unsigned          _nbRuns,_nbRestores; // spill activity of the last search
+   std::size_t       _nbLive; // nodes still allocated by the workers at the end of the last search
+   std::string       _ckFile; // checkpoint file (empty = none)
+   double            _ckPeriod; // seconds between checkpoints
+   std::string       _remote; // coordinator endpoint (empty = standalone search)
    std::function<bool(double)> _timeLimit;
+   bool explore(Bounds& bnds,std::istream* ck);
 public:
-   BAndB(AbstractDD::Ptr dd,const unsigned width)
-      : _theDD(dd),_mxw(width),_timeLimit(nullptr) {}
+   BAndB(AbstractDD::Ptr dd,const unsigned width,const unsigned nbWorkers = 1)
+      : _theDD(dd),_mxw(width),_rxw(0),_dom(true),_domStop(false),_adaptive(false),_proved(false),_cutSet(CSFrontier),_refine(false),_nbCompile(1),
+        _nbw(std::max(1u,nbWorkers)),_ttCap(1 << 20),_budget(0),_nbRuns(0),_nbRestores(0),_nbLive(0),_ckPeriod(0),_timeLimit(nullptr) {}
    ~BAndB() {}
    void search(Bounds& bnds);
+   /**
+    * Continues the search saved in checkpoint `fName` (see `setCheckpoint`). The root is not recompiled.
+    * @return false when the checkpoint cannot be read or the model has no state serializer.
+    */
+   bool resume(Bounds& bnds,const std::string& fName);
+   /**
+    * `lim` gets the milliseconds elapsed since the start and returns true to stop the search. Every
+    * worker calls it before each node, concurrently: it must be thread-safe.
+    */
    void setTimeLimit(std::function<bool(double)> lim) { _timeLimit = lim;}
-};  
+   void setRestrictedWidth(unsigned w) { _rxw = w;}
+   void setDominance(bool on) { _dom = on;}
+   /**
+    * Bounds the in-layer dominance scans of the relaxed and restricted DDs (see `WidthBounded::setEarlyStop`).
+    */
+   void setDominanceEarlyStop(bool on) { _domStop = on;}
+   /**
+    * Lets every worker tune its relaxed and restricted widths independently from the compile time
+    * of its nodes, their cutset sizes, the primal progress and the gap closure. The widths given to
+    * the constructor (and `setRestrictedWidth`) are the starting points.
+    */
+   void setAdaptiveWidth(bool on) { _adaptive = on;}
+   void setNodeSelection(NodeSelection::Ptr sel) { _sel = sel;}
+   void setCutSet(CutSetType t) { _cutSet = t;}
+   /**
+    * Relaxed DDs compiled top-down are tightened by incremental refinement (see `Refined`).
+    */
+   void setRefinement(bool on) { _refine = on;}
+   /**
+    * Each worker expands the layers of its relaxed and restricted DDs with `nbThreads` threads
+    * (see `AbstractDD::expandLayer`). The diagrams are the same as with a single thread.
+    */
+   void setCompileThreads(unsigned nbThreads) { _nbCompile = std::max(1u,nbThreads);}
+   bool proved() const noexcept { return _proved;}
+   void setNbWorkers(unsigned nbw) { _nbw = std::max(1u,nbw);}
+   unsigned getNbWorkers() const noexcept { return _nbw;}
+   void setTableCapacity(std::size_t nbEntries) { _ttCap = nbEntries;}
+   /**
+    * Caps the memory used by the open nodes (split evenly among workers). Beyond the budget,
+    * the worst open nodes are spilled to disk. Requires a state serializer on the DD.
+    */
+   void setMemoryBudget(std::size_t bytes) { _budget = bytes;}
+   unsigned nbSpills() const noexcept   { return _nbRuns;}     // runs of open nodes written to disk by the last search
+   unsigned nbRestores() const noexcept { return _nbRestores;} // reads of spilled runs by the last search
+   /**
+    * B&B nodes still allocated when the last search stopped (open nodes only: 0 once it is proved).
+    */
+   std::size_t nbLiveNodes() const noexcept { return _nbLive;}
+   /**
+    * Saves the open nodes, bounds and incumbent to `fName` every `period` seconds and when the
+    * search stops on its time limit. Requires a state serializer on the DD.
+    */
+   void setCheckpoint(const std::string& fName,double period);
+   /**
+    * Makes `search` one process of a distributed search run by a `BBCoordinator` at `endpoint`
+    * (`unix:<path>` or `tcp:<host>:<port>`). Requires a state serializer on the DD.
+    */
+   void setRemote(const std::string& endpoint) { _remote = endpoint;}
+};
 
 #endif
@@ -0,0 +1,63 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "spill.hpp"
+#include <iostream>
+#include <filesystem>
+#include <atomic>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+SegmentFiles::SegmentFiles(std::size_t segSize)
+   : _segSize(segSize)
+{}
+
+SegmentFiles::~SegmentFiles()
+{
+   for(auto s : _seg)
+      munmap(s,_segSize);
+}
+
+char* SegmentFiles::grow()
+{
+   static std::atomic<unsigned> nbFiles = 0;
+   const auto fName = (std::filesystem::temp_directory_path() /
+                       ("ddopt-" + std::to_string(getpid()) + "-" + std::to_string(nbFiles++) + ".seg")).string();
+   int fd = open(fName.c_str(),O_RDWR | O_CREAT | O_TRUNC,0600);
+   if (fd < 0) {
+      std::cerr << "Spill: cannot create segment " << fName << "\n";
+      throw std::bad_alloc();
+   }
+   unlink(fName.c_str());
+   void* at = MAP_FAILED;
+   if (ftruncate(fd,_segSize) == 0)
+      at = mmap(nullptr,_segSize,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+   close(fd); // the mapping keeps the file alive
+   if (at == MAP_FAILED) {
+      std::cerr << "Spill: cannot map a segment of " << _segSize << " bytes\n";
+      throw std::bad_alloc();
+   }
+   _seg.push_back(static_cast<char*>(at));
+   return _seg.back();
+}
+
+void SegmentFiles::seal(std::size_t k)
+{
+   msync(_seg[k],_segSize,MS_ASYNC);
+   madvise(_seg[k],_segSize,MADV_DONTNEED); // shared mapping: the data stays in the file
+}
@@ -0,0 +1,76 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_SPILL_H
+#define __DDOPT_SPILL_H
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Memory-mapped, append-only segment files.
+ * Each segment is a file of `segSize()` bytes in the temporary directory, mapped shared and unlinked
+ * as soon as it is created (it vanishes with the process). A full segment is *sealed*: its pages are
+ * queued for write-back and dropped from the address space, so the kernel reads them back from the
+ * file on demand instead of keeping them resident. Segments are kept (and reused) until destruction.
+ */
+class SegmentFiles {
+   std::vector<char*> _seg;
+   std::size_t        _segSize;
+public:
+   SegmentFiles(std::size_t segSize);
+   ~SegmentFiles();
+   SegmentFiles(const SegmentFiles&) = delete;
+   SegmentFiles& operator=(const SegmentFiles&) = delete;
+   std::size_t segSize() const noexcept { return _segSize;}
+   std::size_t size() const noexcept { return _seg.size();}
+   char* operator[](std::size_t k) const noexcept { return _seg[k];}
+   /**
+    * Maps one more segment. Throws `std::bad_alloc` (after a message) when the file cannot be created.
+    */
+   char* grow();
+   void seal(std::size_t k);
+};
+
+/**
+ * @brief Append-only log of trivially copyable records held in `SegmentFiles`.
+ * Same interface as the subset of `std::vector` used by the streaming compilation, so either one can
+ * hold the path records (see `Exact::setSpill`). Only the segment being filled stays resident.
+ */
+template <class T> class MappedLog {
+   static_assert(std::is_trivially_copyable_v<T>);
+   SegmentFiles _files;
+   std::size_t  _perSeg; // records per segment
+   std::size_t  _sz;
+public:
+   MappedLog(std::size_t segSize = 64 << 20)
+      : _files(segSize),_perSeg(segSize / sizeof(T)),_sz(0) {}
+   std::size_t size() const noexcept { return _sz;}
+   void clear() noexcept { _sz = 0;}
+   void push_back(const T& r) {
+      const auto k = _sz / _perSeg,at = _sz % _perSeg;
+      if (at == 0 && k > 0)
+         _files.seal(k - 1);
+      char* seg = k < _files.size() ? _files[k] : _files.grow();
+      new (seg + at * sizeof(T)) T(r);
+      ++_sz;
+   }
+   const T& operator[](std::size_t i) const noexcept {
+      return *reinterpret_cast<const T*>(_files[i / _perSeg] + (i % _perSeg) * sizeof(T));
+   }
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#include "taskpool.hpp"
+
+TaskPool::TaskPool(unsigned nbThreads)
+   : _nb(0),_next(0),_busy(0),_gen(0),_stop(false)
+{
+   for(auto i = 1u;i < nbThreads;i++)
+      _threads.emplace_back([this]() { work();});
+}
+
+TaskPool::~TaskPool()
+{
+   {
+      std::lock_guard<std::mutex> lk(_mtx);
+      _stop = true;
+   }
+   _go.notify_all();
+   for(auto& t : _threads)
+      t.join();
+}
+
+void TaskPool::drain()
+{
+   for(std::size_t i;(i = _next++) < _nb;)
+      _job(i);
+}
+
+void TaskPool::work()
+{
+   unsigned seen = 0;
+   std::unique_lock<std::mutex> lk(_mtx);
+   while (true) {
+      _go.wait(lk,[this,&seen] { return _stop || _gen != seen;});
+      if (_stop)
+         return;
+      seen = _gen;
+      lk.unlock();
+      drain();
+      lk.lock();
+      if (--_busy == 0)
+         _done.notify_one();
+   }
+}
+
+void TaskPool::forEach(std::size_t nb,std::function<void(std::size_t)> f)
+{
+   if (_threads.empty() || nb < 2) {
+      for(auto i = 0u;i < nb;i++)
+         f(i);
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lk(_mtx);
+      _job  = std::move(f);
+      _nb   = nb;
+      _next = 0;
+      _busy = _threads.size();
+      ++_gen;
+   }
+   _go.notify_all();
+   drain();
+   std::unique_lock<std::mutex> lk(_mtx);
+   _done.wait(lk,[this] { return _busy == 0;});
+   _job = nullptr;
+}
@@ -0,0 +1,56 @@
+/*
+ * ddOpt is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License  v3
+ * as published by the Free Software Foundation.
+ *
+ * ddOpt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ * See the GNU Lesser General Public License  for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mini-cp. If not, see http://www.gnu.org/licenses/lgpl-3.0.en.html
+ *
+ * Copyright (c)  2023. by Laurent Michel.
+ */
+
+#ifndef __DDOPT_TASKPOOL_H
+#define __DDOPT_TASKPOOL_H
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @brief Fixed set of threads running parallel loops.
+ * The calling thread takes part in every loop, so a pool of size n owns n-1 threads.
+ * Loops are not reentrant: one `forEach` at a time.
+ */
+class TaskPool {
+   std::vector<std::thread>         _threads;
+   std::mutex                       _mtx;
+   std::condition_variable          _go,_done;
+   std::function<void(std::size_t)> _job;
+   std::size_t                      _nb;
+   std::atomic<std::size_t>         _next;
+   unsigned                         _busy; // helpers still on the current loop
+   unsigned                         _gen;  // loop number
+   bool                             _stop;
+   void drain();
+   void work();
+public:
+   typedef std::shared_ptr<TaskPool> Ptr;
+   TaskPool(unsigned nbThreads);
+   ~TaskPool();
+   unsigned size() const noexcept { return _threads.size() + 1;}
+   /**
+    * Calls `f(i)` for every `i` in [0,nb) and returns once all calls are done.
+    * Indices are handed out dynamically.
+    */
+   void forEach(std::size_t nb,std::function<void(std::size_t)> f);
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include <ranges>
 #include <bit>
 #include <algorithm>
+#include <type_traits>
 #include <assert.h>
 //#if defined(__x86_64__)
 //#include <intrin.h>
@@ -77,6 +78,20 @@ namespace std {
    }
 };
 
+/**
+ * Raw binary I/O of trivially copyable values (spill and checkpoint files).
+ */
+template <class T> requires std::is_trivially_copyable_v<T>
+inline void writeBin(std::ostream& os,const T& v) {
+   os.write(reinterpret_cast<const char*>(&v),sizeof(T));
+}
+template <class T> requires std::is_trivially_copyable_v<T>
+inline T readBin(std::istream& is) {
+   T v {};
+   is.read(reinterpret_cast<char*>(&v),sizeof(T));
+   return v;
+}
+
 class Range {
    constexpr static int inc[2] = {+1,-1};
    int _from;
@@ -106,6 +121,7 @@ public:
    auto from() const noexcept  { return _from;}
    auto to() const noexcept    { return _to;}
    auto flip() const noexcept  { return Range(_to -1,_from-1);}
+   auto ascending() const noexcept { return (_from <= _to) ? *this : Range(_to + 1,_from + 1);} // same values, increasing
    auto begin() const noexcept { return iterator(_from <= _to ? Forward : Backward,_from); }
    auto end() const  noexcept  { return iterator(_from <= _to ? Forward : Backward,_to); }
    static Range open(int f,int t) noexcept  { return Range(f,t);}
@@ -525,6 +541,19 @@ public:
    }
    short nbWords() const noexcept { return _mxw;}
    int largestPossible() const noexcept { return _nbp;}
+   void write(std::ostream& os) const {
+      writeBin(os,_mxw);
+      writeBin(os,_nbp);
+      os.write(reinterpret_cast<const char*>(_t),sizeof(unsigned long long) * _mxw);
+   }
+   static GNSet read(std::istream& is) {
+      GNSet s(0);
+      s._mxw = readBin<unsigned short>(is);
+      s._nbp = readBin<unsigned short>(is);
+      s._t   = s._mxw ? new unsigned long long[s._mxw] : nullptr;
+      is.read(reinterpret_cast<char*>(s._t),sizeof(unsigned long long) * s._mxw);
+      return s;
+   }
    void clear() noexcept {
       for(short i=0;i < _mxw;i++)
          _t[i] = 0;
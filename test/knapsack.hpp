@@ -0,0 +1,150 @@
+#ifndef __KNAPSACK_HPP__
+#define __KNAPSACK_HPP__
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <bit>
+#include "codd.hpp"
+
+/**
+ * The 0/1 knapsack shared by the DD and B&B tests: states, a random instance, the reference
+ * value (plain DP) and the model.
+ */
+struct SKS {
+   int n;           // item index
+   int c;           // remaining capacity
+   friend std::ostream& operator<<(std::ostream& os,const SKS& m) {
+      return os << "<" << m.n << ',' << m.c << ">";
+   }
+};
+
+template<> struct std::equal_to<SKS> {
+   constexpr bool operator()(const SKS& s1,const SKS& s2) const {
+      return s1.n == s2.n && s1.c == s2.c;
+   }
+};
+
+template<> struct std::hash<SKS> {
+   std::size_t operator()(const SKS& v) const noexcept {
+      return std::rotl(std::hash<int>{}(v.n),32) ^ std::hash<int>{}(v.c);
+   }
+};
+
+struct Knapsack {
+   const int I,capa;
+   std::vector<int> w,p;
+   mutable std::atomic<long> nbTrans,nbLocal; // calls to the transition function and to the local bound
+   /**
+    * `I` random items. With `correlated`, profits stay close to weights (a large B&B open list).
+    */
+   Knapsack(unsigned seed,int nbItems,int capacity,bool correlated = false)
+      : I(nbItems),capa(capacity),w(nbItems),p(nbItems),nbTrans(0),nbLocal(0)
+   {
+      std::mt19937 rng(seed);
+      for(int i=0;i < I;i++) {
+         if (correlated) {
+            w[i] = 20 + rng() % 60;
+            p[i] = w[i] + rng() % 10;
+         } else {
+            w[i] = 5 + rng() % 40;
+            p[i] = 1 + rng() % 60;
+         }
+      }
+   }
+   /**
+    * @return the profit of the labels `inc` (one per item), -1 when they do not fit.
+    */
+   int value(const std::vector<int>& inc) const {
+      int v = 0,rc = capa;
+      for(int i=0;i < (int)inc.size();i++)
+         if (inc[i]) {
+            v  += p[i];
+            rc -= w[i];
+         }
+      return inc.size() != (std::size_t)I || rc < 0 ? -1 : v;
+   }
+   /**
+    * A `Bounds` that aborts on an infeasible incumbent.
+    */
+   Bounds checkedBounds() const {
+      return Bounds([this](const std::vector<int>& inc) {
+         if (value(inc) < 0) abort();
+      });
+   }
+};
+
+/**
+ * Plain DP over the capacities: the reference value.
+ */
+inline int knapsackDP(const Knapsack& ks)
+{
+   std::vector<int> best(ks.capa + 1,0);
+   for(int i=0;i < ks.I;i++)
+      for(int c=ks.capa;c >= ks.w[i];c--)
+         best[c] = std::max(best[c],best[c - ks.w[i]] + ks.p[i]);
+   return best[ks.capa];
+}
+
+/**
+ * The knapsack DD with labels given by `lgf` (0 and 1 for an item that fits).
+ * @param withLocal adds a local bound (every remaining item that still fits)
+ * @param serialize adds a state serializer (spill files, checkpoints, distributed search)
+ */
+template <class LGF>
+auto makeKnapsackDD(const Knapsack& ks,LGF lgf,bool withLocal = false,bool serialize = false)
+{
+   const auto init   = [&ks]() { return SKS {0,ks.capa};};
+   const auto target = [&ks]() { return SKS {ks.I,0};};
+   const auto stf = [&ks](const SKS& s,const int label) -> std::optional<SKS> {
+      ++ks.nbTrans;
+      if (s.n < ks.I-1)
+         return SKS { s.n+1,s.c - label * ks.w[s.n] };
+      else return SKS { ks.I,0 };
+   };
+   const auto scf = [&ks](const SKS& s,int label) { return ks.p[s.n] * label;};
+   const auto smf = [](const SKS& s1,const SKS& s2) -> std::optional<SKS> {
+      return SKS { std::max(s1.n,s2.n),std::max(s1.c,s2.c) };
+   };
+   const auto sEq = [&ks](const SKS& s) -> bool { return s.n == ks.I;};
+   const auto local = [&ks](const SKS& s,LocalContext) -> double {
+      ++ks.nbLocal;
+      double ub = 0;
+      for(int i=s.n;i < ks.I;i++)
+         if (ks.w[i] <= s.c)
+            ub += ks.p[i];
+      return ub;
+   };
+   auto theDD = DD<SKS,Maximize<double>,
+                   decltype(target),
+                   LGF,
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(sEq),
+                   decltype(local)
+                   >::makeDD(init,target,lgf,stf,scf,smf,sEq,GNSet(0,1),
+                             withLocal ? std::function<double(const SKS&,LocalContext)>(local) : nullptr);
+   if (serialize)
+      theDD->setStateSerializer([](std::ostream& os,const SKS& s) {
+         writeBin(os,s.n);
+         writeBin(os,s.c);
+      },[](std::istream& is) {
+         const auto n = readBin<int>(is);
+         return SKS { n,readBin<int>(is) };
+      });
+   return theDD;
+}
+
+inline auto knapsackLabels(const Knapsack& ks)
+{
+   return [&ks](const SKS& s,DDContext) { return Range::close(0,s.c >= ks.w[s.n]);};
+}
+
+inline auto makeKnapsackDD(const Knapsack& ks,bool withLocal = false,bool serialize = false)
+{
+   return makeKnapsackDD(ks,knapsackLabels(ks),withLocal,serialize);
+}
+
+#endif
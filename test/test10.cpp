@@ -0,0 +1,34 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+#include "util.hpp"
+
+int t0() {
+   GNSet s {0,3,64,65,127};
+   std::stringstream buf;
+   s.write(buf);
+   writeBin(buf,42);
+   writeBin(buf,3.5);
+   GNSet r = GNSet::read(buf);
+   auto i = readBin<int>(buf);
+   auto d = readBin<double>(buf);
+   std::cout << "S= " << s << " R= " << r << " I=" << i << " D=" << d << "\n";
+   if (!(s == r) || i != 42 || d != 3.5) abort();
+   return 0;
+}
+
+int t1() {
+   GNSet s(0);
+   std::stringstream buf;
+   s.write(buf);
+   GNSet r = GNSet::read(buf);
+   std::cout << "EMPTY R= " << r << "\n";
+   if (!r.empty() || r.nbWords() != 0) abort();
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+}
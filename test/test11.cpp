@@ -0,0 +1,32 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "taskpool.hpp"
+
+int t0() {
+   TaskPool tp(4);
+   std::vector<long> out(1000);
+   for(int r=0;r < 200;r++) {  // many loops: every helper must see every generation
+      tp.forEach(out.size(),[&out,r](std::size_t i) { out[i] = i * r;});
+      for(auto i=0u;i < out.size();i++)
+         if (out[i] != (long)i * r) abort();
+   }
+   std::cout << "POOL(" << tp.size() << ") OK\n";
+   return 0;
+}
+
+int t1() {
+   TaskPool tp(1);   // no helper: the caller runs everything
+   int nb = 0;
+   tp.forEach(10,[&nb](std::size_t) { nb++;});
+   tp.forEach(0,[&nb](std::size_t) { abort();});
+   if (nb != 10) abort();
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+}
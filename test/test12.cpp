@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include "conchash.hpp"
+
+int t0() {  // every thread interns the same keys: one node per key, created once
+   const int nbk = 20000,nbt = 8;
+   CHashtable<int> tab(1000);
+   std::vector<std::unique_ptr<Pool>> pools;
+   for(int t=0;t < nbt;t++)
+      pools.emplace_back(new Pool);
+   std::atomic<int> made = 0;
+   std::vector<std::vector<Node<int>*>> got(nbt,std::vector<Node<int>*>(nbk));
+   std::vector<std::thread> thr;
+   for(int t=0;t < nbt;t++)
+      thr.emplace_back([&,t]() {
+         for(int i=0;i < nbk;i++) {
+            const int k = (i * 7919 + t * 13) % nbk;
+            got[t][k] = tab.intern(k,[&]() {
+               ++made;
+               return new (pools[t].get()) Node<int>(pools[t].get(),int(k),k,true);
+            }).first;
+         }
+      });
+   for(auto& t : thr)
+      t.join();
+   std::cout << "INTERNED:" << tab.size() << " MADE:" << made << "\n";
+   if (tab.size() != nbk || made != nbk) abort();
+   for(int k=0;k < nbk;k++) {
+      if (got[0][k]->get() != k || tab.find(k) != got[0][k]) abort();
+      for(int t=1;t < nbt;t++)
+         if (got[t][k] != got[0][k]) abort();
+   }
+   return 0;
+}
+
+int t1() {  // clear recycles the table
+   Pool pool;
+   CHashtable<int> tab(10);
+   for(int r=0;r < 3;r++) {
+      for(int i=0;i < 2000;i++) {
+         auto [n,ins] = tab.intern(i,[&]() { return new (&pool) Node<int>(&pool,int(i),i,true);});
+         if (!ins || n->get() != i) abort();
+      }
+      if (tab.find(1999) == nullptr || tab.find(2000) != nullptr) abort();
+      unsigned nb = 0;
+      tab.doOnAll([&nb](Node<int>*) { ++nb;});
+      if (nb != 2000 || tab.size() != 2000) abort();
+      tab.clear();
+      if (tab.size() != 0 || tab.find(5) != nullptr) abort();
+   }
+   std::cout << "CLEAR OK\n";
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+}
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "knapsack.hpp"
+
+/**
+ * Number of nodes of every layer of a compiled diagram, found from the root.
+ */
+std::vector<std::size_t> layerSizes(AbstractDD::Ptr dd)
+{
+   std::vector<std::size_t> sz;
+   std::vector<ANode::Ptr> seen { dd->getRoot() };
+   for(std::size_t h = 0;h < seen.size();h++) {
+      auto n = seen[h];
+      sz.resize(std::max<std::size_t>(sz.size(),n->getLayer() + 1),0);
+      sz[n->getLayer()]++;
+      for(auto ki = n->beginKids();ki != n->endKids();ki++)
+         if (std::find(seen.begin(),seen.end(),(*ki)->_to) == seen.end())
+            seen.push_back((*ki)->_to);
+   }
+   return sz;
+}
+
+int t0() {
+   Knapsack ks(7,40,300);
+   const int best = knapsackDP(ks);
+   std::size_t twoLayers = 0,all = 0; // of the layered exact diagram, sink excluded
+   const auto check = [&](AbstractDD::Ptr dd,bool streaming,bool spill) {
+      Exact ex;
+      ex.setStreaming(streaming);
+      ex.setSpill(spill);
+      dd->setStrategy(&ex);
+      Bounds bnds(dd);
+      dd->compute(bnds);
+      const auto v = ks.value(dd->incumbent());
+      std::cout << (spill ? "SPILLED" : streaming ? "STREAMING" : "EXACT") << ": " << dd->currentOpt() << " INC:" << v
+                << " DP:" << best << "\n";
+      if (dd->currentOpt() != best || v != best) abort();
+      if (!streaming) {
+         const auto sz = layerSizes(dd); // the sink is alone in the last layer
+         for(auto l = 0u;l + 1 < sz.size();l++) {
+            all += sz[l];
+            if (l + 2 < sz.size())
+               twoLayers = std::max(twoLayers,sz[l] + sz[l+1]);
+         }
+      } else {
+         // Only the layer being expanded and the next one are held: the two widest neighbours at the peak.
+         std::cout << "\tPEAK:" << dd->streamPeak() << " TWO LAYERS:" << twoLayers << " ALL:" << all
+                   << " RECORDS:" << dd->streamHeapBytes() << "B/" << dd->streamDiskRecords() << "\n";
+         if (dd->streamPeak() != twoLayers || 4 * dd->streamPeak() >= all) abort();
+         // One path record per state but the root: on the heap, or only in segment files when spilled.
+         if (spill ? dd->streamHeapBytes() != 0 || dd->streamDiskRecords() != all - 1
+                   : dd->streamHeapBytes() < (all - 1) * 8 || dd->streamDiskRecords() != 0)
+            abort();
+      }
+   };
+   auto theDD = makeKnapsackDD(ks);
+   check(theDD,false,false);
+   check(theDD->duplicate(),true,false);
+   check(theDD->duplicate(),true,true);
+   return 0;
+}
+
+int t1() {
+   struct Rec { std::uint32_t a; int b;};
+   MappedLog<Rec> log(4096); // 512 records per segment
+   for(int round=0;round < 2;round++) { // the second round reuses the sealed segments
+      log.clear();
+      const int n = 100000 + round;
+      for(int i=0;i < n;i++)
+         log.push_back(Rec { (std::uint32_t)i * 7,-i });
+      if (log.size() != (std::size_t)n) abort();
+      for(int i=n-1;i >= 0;i--)
+         if (log[i].a != (std::uint32_t)i * 7 || log[i].b != -i) abort();
+   }
+   std::cout << "LOG: ok\n";
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+}
@@ -0,0 +1,39 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "knapsack.hpp"
+
+int t0(unsigned seed) {
+   Knapsack ks(seed,30,250);
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks);
+   // Root bounds: both relaxations are valid and the refined one is at least as tight.
+   double rb[2];
+   for(int k=0;k < 2;k++) {
+      Relaxed rel(8);
+      Refined ref(8);
+      auto dd = theDD->duplicate();
+      dd->setStrategy(k ? (Strategy*)&ref : (Strategy*)&rel);
+      Bounds bnds(dd);
+      dd->compute(bnds);
+      rb[k] = dd->currentOpt();
+      if (rb[k] < best) abort();
+   }
+   if (rb[1] > rb[0]) abort();
+   // B&B with refined relaxations.
+   Bounds bnds = ks.checkedBounds();
+   BAndB engine(theDD,8);
+   engine.setRefinement(true);
+   engine.search(bnds);
+   std::cout << "SEED:" << seed << " RELAXED:" << rb[0] << " REFINED:" << rb[1] << " B&B:" << bnds.getPrimal()
+             << " DP:" << best << "\n";
+   if (bnds.getPrimal() != best) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 5;s++)
+      t0(s);
+}
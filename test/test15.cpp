@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "knapsack.hpp"
+
+int t0(unsigned seed) {
+   Knapsack ks(seed,40,300);
+   const int best = knapsackDP(ks);
+   const auto run = [&](std::size_t cache,std::size_t succ,unsigned nbw) {
+      auto theDD = makeKnapsackDD(ks,true);
+      if (cache)
+         theDD->setLocalCache(cache == ~0ul ? 0 : cache);
+      if (succ)
+         theDD->setSuccessorCache(succ == ~0ul ? 0 : succ);
+      Bounds bnds = ks.checkedBounds();
+      ks.nbLocal = ks.nbTrans = 0;
+      BAndB engine(theDD,4,nbw);
+      engine.search(bnds);
+      if (bnds.getPrimal() != best) abort();
+      if (cache || succ) {
+         std::cout << "CACHE:";
+         theDD->printCaches(std::cout);
+         std::cout << "\n";
+      }
+      return std::make_pair(ks.nbLocal.load(),ks.nbTrans.load());
+   };
+   const auto plain     = run(0,0,1);
+   const auto unbounded = run(~0ul,0,1);
+   const auto small     = run(64,0,1);
+   const auto succ      = run(0,~0ul,1);
+   const auto tiny      = run(0,64,1);
+   run(256,256,2);  // workers share the tables
+   std::cout << "SEED:" << seed << " CALLS:" << plain.first << "/" << unbounded.first << "/" << small.first
+             << " TRANS:" << plain.second << "/" << succ.second << "/" << tiny.second << " DP:" << best << "\n";
+   if (unbounded.first >= plain.first || small.first > plain.first) abort();
+   if (succ.second >= plain.second || tiny.second > plain.second) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 3;s++)
+      t0(s);
+}
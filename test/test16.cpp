@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <ranges>
+#include <sstream>
+#include <algorithm>
+#include "knapsack.hpp"
+
+// Same knapsack, with labels given as a GNSet, a backward Range, a view and through the expansion hook.
+int t0(unsigned seed) {
+   Knapsack ks(seed,40,300);
+   const int best = knapsackDP(ks);
+   double ref[2] = {0,0}; // exact values of the first model. Every other model must compile to the same diagrams.
+   const auto check = [&](AbstractDD::Ptr dd,const char* name) {
+      for(int k=0;k < 2;k++) { // exact (layer by layer, then streaming)
+         Exact ex;
+         ex.setStreaming(k == 1);
+         auto cp = dd->duplicate();
+         cp->setStrategy(&ex);
+         Bounds bnds(cp);
+         cp->compute(bnds);
+         if (ref[k] == 0)
+            ref[k] = cp->currentOpt();
+         if (cp->currentOpt() != ref[k]) abort();
+      }
+      double bb[2];
+      for(int k=0;k < 2;k++) { // B&B, then with parallel layer expansion
+         Bounds bnds = ks.checkedBounds();
+         BAndB engine(dd,4);
+         engine.setCompileThreads(k ? 2 : 1);
+         engine.search(bnds);
+         bb[k] = bnds.getPrimal();
+      }
+      std::cout << "SEED:" << seed << " " << name << " B&B:" << bb[0] << "/" << bb[1] << " DP:" << best << "\n";
+      if (bb[0] != best || bb[1] != best) abort();
+   };
+   const auto& w = ks.w;
+   check(makeKnapsackDD(ks,[&w](const SKS& s,DDContext) { return GNSet(Range::close(0,s.c >= w[s.n]));},true),"GNSET");
+   check(makeKnapsackDD(ks,[&w](const SKS& s,DDContext) { return Range::close(s.c >= w[s.n],0);},true),"RANGE"); // 1 then 0
+   check(makeKnapsackDD(ks,[&w](const SKS& s,DDContext) { return std::views::iota(0,1 + (s.c >= w[s.n]));},true),"VIEW");
+   {
+      auto theDD = makeKnapsackDD(ks,true);
+      theDD->setExpander([&ks](const SKS& s,DDContext,std::vector<Successor<SKS>>& out) {
+         const SKS nx = s.n < ks.I-1 ? SKS { s.n+1,s.c } : SKS { ks.I,0 };
+         out.push_back(Successor<SKS> { 0,nx,0 });
+         if (s.c >= ks.w[s.n])
+            out.push_back(Successor<SKS> { 1,s.n < ks.I-1 ? SKS { s.n+1,s.c - ks.w[s.n] } : nx,(double)ks.p[s.n] });
+      });
+      check(theDD,"HOOK");
+   }
+   return 0;
+}
+
+/**
+ * What a compilation produced: the number of nodes of each layer, the number of arcs, the optimum and
+ * the cutset (states and bounds, in order).
+ */
+struct Shape {
+   std::vector<unsigned>    layers;
+   unsigned                 nbArcs = 0;
+   double                   opt = 0;
+   std::vector<std::string> cut;
+   bool operator==(const Shape&) const = default;
+};
+
+Shape shapeOf(AbstractDD::Ptr dd,Bounds& bnds,bool withCut)
+{
+   Shape sh;
+   std::vector<ANode::Ptr> seen { dd->getRoot() };
+   for(std::size_t h = 0;h < seen.size();h++) {
+      auto n = seen[h];
+      if (sh.layers.size() <= n->getLayer())
+         sh.layers.resize(n->getLayer() + 1,0);
+      sh.layers[n->getLayer()]++;
+      for(auto ki = n->beginKids();ki != n->endKids();ki++) {
+         sh.nbArcs++;
+         if (std::find(seen.begin(),seen.end(),(*ki)->_to) == seen.end())
+            seen.push_back((*ki)->_to);
+      }
+   }
+   sh.opt = dd->currentOpt();
+   if (withCut)
+      for(auto n : dd->computeCutSet(bnds)) {
+         std::ostringstream os;
+         dd->printNode(os,n);
+         os << '@' << n->getLayer() << ':' << n->getBound() << '/' << n->getBackwardBound();
+         sh.cut.push_back(os.str());
+      }
+   return sh;
+}
+
+// Parallel layer expansion compiles the same relaxed and restricted diagrams as a single thread.
+int t1(unsigned seed) {
+   Knapsack ks(seed,40,300);
+   auto theDD = makeKnapsackDD(ks,true);
+   Shape shape[2][2]; // [threads][relaxed/restricted]
+   for(int k=0;k < 2;k++) {
+      auto rel = theDD->duplicate(),res = theDD->duplicate();
+      if (k) {
+         auto tp = std::make_shared<TaskPool>(4);
+         rel->setTaskPool(tp);
+         res->setTaskPool(tp);
+      }
+      Restricted rs(32);
+      Relaxed    rx(32);
+      res->setStrategy(&rs);
+      rel->setStrategy(&rx);
+      Bounds bnds;
+      res->compute(bnds);
+      bnds.setPrimal(res->currentOpt());
+      rel->compute(bnds);
+      shape[k][0] = shapeOf(rel,bnds,true);
+      shape[k][1] = shapeOf(res,bnds,false);
+   }
+   std::cout << "SEED:" << seed << " RELAXED:" << shape[1][0].opt << " LAYERS:" << shape[1][0].layers.size()
+             << " ARCS:" << shape[1][0].nbArcs << " |CS|:" << shape[1][0].cut.size()
+             << " RESTRICTED:" << shape[1][1].opt << "\n";
+   if (shape[0][0].cut.empty() || shape[0][0].opt == shape[0][1].opt) abort(); // neither diagram is exact
+   if (!(shape[0][0] == shape[1][0]) || !(shape[0][1] == shape[1][1])) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 3;s++) {
+      t0(s);
+      t1(s);
+   }
+}
@@ -0,0 +1,34 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "knapsack.hpp"
+
+int t0(unsigned seed) {
+   Knapsack ks(seed,60,800,true); // correlated: a large open list
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,false,true);
+   // The same search in memory, then under a budget that forces the open nodes through the spill file,
+   // then under the budget with workers stealing from each other. Every node must be recycled.
+   for(int k=0;k < 3;k++) {
+      Bounds bnds;
+      BAndB engine(theDD,4,k == 2 ? 4 : 1);
+      if (k)
+         engine.setMemoryBudget(k == 2 ? 4096 : 1024);
+      engine.search(bnds);
+      std::cout << "SEED:" << seed << " RUN:" << k << " B&B:" << bnds.getPrimal() << " DP:" << best
+                << " SPILLS:" << engine.nbSpills() << "/" << engine.nbRestores() << " LIVE:" << engine.nbLiveNodes() << "\n";
+      if (bnds.getPrimal() != best || !engine.proved() || engine.nbLiveNodes() != 0) abort();
+      // In memory, nothing touches the spill file. Under a budget, every spilled run is read back before the proof.
+      if (k ? engine.nbSpills() == 0 || engine.nbRestores() < engine.nbSpills()
+            : engine.nbSpills() != 0 || engine.nbRestores() != 0)
+         abort();
+   }
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 3;s++)
+      t0(s);
+}
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include "knapsack.hpp"
+
+// Stops a knapsack B&B after a few nodes, resumes it from its checkpoint and checks the optimum.
+int t0(unsigned seed) {
+   Knapsack ks(seed,60,800,true); // correlated: a large open list
+   auto theDD = makeKnapsackDD(ks,false,true);
+   Bounds ref;
+   BAndB whole(theDD,4);
+   whole.search(ref);
+   if (ref.getPrimal() != knapsackDP(ks) || !whole.proved()) abort();
+
+   const auto ck = (std::filesystem::temp_directory_path() / ("codd_test18_" + std::to_string(seed) + ".ck")).string();
+   unsigned nbCalls = 0;
+   Bounds part;
+   BAndB first(theDD,4);
+   first.setCheckpoint(ck,3600); // only the final checkpoint
+   first.setTimeLimit([&nbCalls](double) { return ++nbCalls > 50;});
+   first.search(part);
+   if (first.proved()) abort();
+
+   Bounds none;
+   BAndB blind(makeKnapsackDD(ks),4); // no serializer: the checkpoint cannot be read back
+   if (blind.resume(none,ck)) abort();
+
+   Bounds bnds;
+   BAndB second(theDD,4);
+   if (!second.resume(bnds,ck)) abort();
+   std::filesystem::remove(ck);
+   std::cout << "SEED:" << seed << " WHOLE:" << ref.getPrimal() << " STOPPED:" << part.getPrimal()
+             << " RESUMED:" << bnds.getPrimal() << " DP:" << knapsackDP(ks) << "\n";
+   if (!second.proved() || bnds.getPrimal() != ref.getPrimal()) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 3;s++)
+      t0(s);
+}
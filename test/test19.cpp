@@ -0,0 +1,39 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include "knapsack.hpp"
+
+// The same knapsack under every node selection policy: same optimum, a proof, and a valid dual when stopped early.
+int t0(unsigned seed) {
+   Knapsack ks(seed,50,500,true);
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,true);
+   const NodeSelection::Ptr pols[] = { std::make_shared<BestFirst>(),std::make_shared<DepthFirst>(),
+                                       std::make_shared<BestEstimate>() };
+   for(auto sel : pols)
+      for(unsigned nbw=1;nbw <= 2;nbw++) {
+         Bounds bnds = ks.checkedBounds();
+         BAndB engine(theDD,4,nbw);
+         engine.setNodeSelection(sel);
+         engine.search(bnds);
+         std::atomic<unsigned> nbCalls = 0; // both workers check the time limit
+         Bounds part = ks.checkedBounds();
+         BAndB stopped(theDD,4,nbw);
+         stopped.setNodeSelection(sel);
+         stopped.setTimeLimit([&nbCalls](double) { return ++nbCalls > 40;});
+         stopped.search(part);
+         std::cout << "SEED:" << seed << " " << sel->getName() << "(" << nbw << ") B&B:" << bnds.getPrimal()
+                   << " STOPPED:" << part.getPrimal() << "/" << part.getDual() << " DP:" << best << "\n";
+         if (bnds.getPrimal() != best || !engine.proved()) abort();
+         if (stopped.proved() || part.getDual() < best) abort(); // maximization: the dual bounds the optimum from above
+      }
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 2;s++)
+      t0(s);
+}
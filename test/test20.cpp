@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "knapsack.hpp"
+#include "distributed.hpp"
+
+// A coordinator on a Unix socket and two forked B&B processes: everybody ends with the DP optimum.
+int t0(unsigned seed) {
+   Knapsack ks(seed,50,500,true);
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,true,true);
+   char dir[] = "/tmp/codd_test20_XXXXXX";
+   if (!mkdtemp(dir)) abort();
+   const std::string ep = std::string("unix:") + dir + "/coord.sock";
+   std::vector<pid_t> kids;
+   std::cout.flush(); // not twice through the children
+   for(int i=0;i < 2;i++) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+         alarm(120);
+         Bounds bnds = ks.checkedBounds();
+         BAndB engine(theDD,4,2); // donations also take nodes from the peer thread
+         engine.setRemote(ep);
+         engine.search(bnds);
+         std::cout << "SEED:" << seed << " PROCESS:" << i << " B&B:" << bnds.getPrimal() << " DP:" << best << std::endl;
+         exit(bnds.getPrimal() == best && engine.proved() ? 0 : 1);
+      }
+      if (pid < 0) abort();
+      kids.push_back(pid);
+   }
+   alarm(120); // the coordinator must terminate
+   Bounds bnds = ks.checkedBounds();
+   if (!BBCoordinator(theDD,ep,2).run(bnds)) abort();
+   alarm(0);
+   for(auto pid : kids) {
+      int status = 0;
+      if (waitpid(pid,&status,0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) abort();
+   }
+   std::filesystem::remove_all(dir);
+   std::cout << "SEED:" << seed << " COORDINATOR:" << bnds.getPrimal() << " DP:" << best << "\n";
+   if (bnds.getPrimal() != best) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 2;s++)
+      t0(s);
+}
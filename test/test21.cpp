@@ -0,0 +1,29 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "knapsack.hpp"
+
+// A fast and a slow configuration share one Bounds: the fast one proves the DP optimum and stops the slow one.
+int t0(unsigned seed) {
+   Knapsack ks(seed,60,800,true);
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,true);
+   Portfolio pf(theDD);
+   pf.add(BBConfig { .width = 400 });  // many expensive nodes
+   pf.add(BBConfig { .width = 1 });
+   pf.setTimeLimit([](double) { return false;}); // only the winner can stop the others
+   Bounds bnds = ks.checkedBounds();
+   const int winner = pf.search(bnds);
+   std::cout << "SEED:" << seed << " WINNER:" << winner << " PORTFOLIO:" << bnds.getPrimal() << " DP:" << best
+             << "\n";
+   if (winner != 1 || !pf.proved(1) || bnds.getPrimal() != best) abort();
+   if (pf.proved(0)) abort(); // stopped by the winner
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 2;s++)
+      t0(s);
+}
@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "knapsack.hpp"
+
+// Drives a WidthControl through each of its rules and checks that the widths move and stay in [w/4,8w].
+int t0() {
+   Relaxed    rel(16);
+   Restricted res(16);
+   WidthControl wc(&rel,&res);
+   const auto feed = [&wc](unsigned nb,double us,std::size_t cut,bool better,double gap) {
+      unsigned nbChanges = 0;
+      for(auto i = 0u;i < nb;i++)
+         nbChanges += wc.record(us,cut,better,gap);
+      return nbChanges;
+   };
+   const auto inRange = [&]() {
+      return rel.getWidth() >= 4 && rel.getWidth() <= 128 && res.getWidth() >= 4 && res.getWidth() <= 128;
+   };
+   // Cheap nodes with large cutsets, improving primal: only the relaxed width shrinks, down to 16/4.
+   if (feed(64 * 20,10,20,true,0.5) == 0) abort();
+   std::cout << "SHRUNK:" << rel.getWidth() << "/" << res.getWidth() << "\n";
+   if (rel.getWidth() != 4 || res.getWidth() != 16 || !inRange()) abort();
+   // Expensive nodes, a stalled gap and no primal progress: both widths grow, up to 16*8.
+   if (feed(64 * 20,1e5,1,false,0.5) == 0) abort();
+   std::cout << "GROWN:" << rel.getWidth() << "/" << res.getWidth() << "\n";
+   if (rel.getWidth() != 128 || res.getWidth() != 128 || !inRange()) abort();
+   // Closing gap and improving primal: nothing moves.
+   double gap = 0.5;
+   for(auto i = 0u;i < 64 * 4;i++)
+      if (wc.record(1e5,1,true,gap *= 0.99)) abort();
+   return 0;
+}
+
+// The adaptive B&B still proves the DP optimum.
+int t1(unsigned seed) {
+   Knapsack ks(seed,40,300);
+   auto theDD = makeKnapsackDD(ks,true);
+   Bounds bnds = ks.checkedBounds();
+   BAndB engine(theDD,4);
+   engine.setAdaptiveWidth(true);
+   engine.search(bnds);
+   std::cout << "SEED:" << seed << " ADAPTIVE:" << bnds.getPrimal() << " DP:" << knapsackDP(ks) << "\n";
+   if (bnds.getPrimal() != knapsackDP(ks) || !engine.proved()) abort();
+   return 0;
+}
+
+int main()
+{
+   t0();
+   for(unsigned s=1;s <= 2;s++)
+      t1(s);
+}
@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <climits>
+#include <algorithm>
+#include "knapsack.hpp"
+
+struct TOUR {
+   unsigned vis;  // cities visited so far (bit mask)
+   int      e;    // last city
+   int      hops;
+   friend std::ostream& operator<<(std::ostream& os,const TOUR& m) {
+      return os << "<" << m.vis << ',' << m.e << ',' << m.hops << ">";
+   }
+};
+
+template<> struct std::equal_to<TOUR> {
+   constexpr bool operator()(const TOUR& s1,const TOUR& s2) const {
+      return s1.vis == s2.vis && s1.e == s2.e && s1.hops == s2.hops;
+   }
+};
+
+template<> struct std::hash<TOUR> {
+   std::size_t operator()(const TOUR& v) const noexcept {
+      return (std::hash<unsigned>{}(v.vis) << 16) ^ (std::hash<int>{}(v.e) << 8) ^ std::hash<int>{}(v.hops);
+   }
+};
+
+static const CutSetType cutSets[] = { CSFrontier,CSLastExactLayer };
+
+// Both cutsets prove the DP optimum of a knapsack.
+int t0(unsigned seed) {
+   Knapsack ks(seed,40,300);
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,true);
+   for(auto cs : cutSets) {
+      Bounds bnds = ks.checkedBounds();
+      BAndB engine(theDD,4);
+      engine.setCutSet(cs);
+      engine.search(bnds);
+      std::cout << "SEED:" << seed << " KNAPSACK CS:" << cs << " B&B:" << bnds.getPrimal() << " DP:" << best << "\n";
+      if (bnds.getPrimal() != best || !engine.proved()) abort();
+   }
+   return 0;
+}
+
+// Both cutsets prove the optimal tour of a small random TSP (Held-Karp for the reference value).
+int t1(unsigned seed) {
+   std::mt19937 rng(seed);
+   const int n = 9;
+   std::vector<std::vector<int>> d(n,std::vector<int>(n,0));
+   for(int i=0;i < n;i++)
+      for(int j=i+1;j < n;j++)
+         d[i][j] = d[j][i] = 1 + rng() % 100;
+   const unsigned all = (1u << n) - 1;
+   std::vector<std::vector<int>> hk(1u << n,std::vector<int>(n,INT_MAX / 2)); // from 0 through the set, ending at j
+   hk[1][0] = 0;
+   for(unsigned s=1;s <= all;s += 2)
+      for(int j=0;j < n;j++)
+         if (hk[s][j] < INT_MAX / 2)
+            for(int k=1;k < n;k++)
+               if (!(s & (1u << k)))
+                  hk[s | (1u << k)][k] = std::min(hk[s | (1u << k)][k],hk[s][j] + d[j][k]);
+   int best = INT_MAX;
+   for(int j=1;j < n;j++)
+      best = std::min(best,hk[all][j] + d[j][0]);
+   const auto init   = []()  { return TOUR { 1u,0,0 };};
+   const auto target = [=]() { return TOUR { all,0,n };};
+   const auto lgf = [=](const TOUR& s,DDContext) {
+      if (s.hops >= n-1)
+         return GNSet {0};
+      GNSet out {};
+      for(int k=1;k < n;k++)
+         if (!(s.vis & (1u << k)))
+            out.insert(k);
+      return out;
+   };
+   const auto stf = [=](const TOUR& s,const int label) -> std::optional<TOUR> {
+      if (label == 0)
+         return TOUR { all,0,n };
+      else return TOUR { s.vis | (1u << label),label,s.hops + 1 };
+   };
+   const auto scf = [&d](const TOUR& s,int label) { return d[s.e][label];};
+   const auto smf = [](const TOUR& s1,const TOUR& s2) -> std::optional<TOUR> {
+      if (s1.e == s2.e && s1.hops == s2.hops)
+         return TOUR { s1.vis & s2.vis,s1.e,s1.hops };
+      else return std::nullopt;
+   };
+   const auto eqs = [=](const TOUR& s) -> bool { return s.hops == n;};
+   auto theDD = DD<TOUR,Minimize<double>,
+                   decltype(target),
+                   decltype(lgf),
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(eqs)
+                   >::makeDD(init,target,lgf,stf,scf,smf,eqs,setFrom(std::views::iota(0,n)));
+   for(auto cs : cutSets) {
+      Bounds bnds([&](const std::vector<int>& inc) {
+         unsigned seen = 1;
+         int at = 0;
+         for(auto c : inc) {
+            seen |= 1u << c;
+            at = c;
+         }
+         if (inc.size() != (std::size_t)n || at != 0 || seen != all) abort();
+      });
+      BAndB engine(theDD,4);
+      engine.setCutSet(cs);
+      engine.search(bnds);
+      std::cout << "SEED:" << seed << " TSP CS:" << cs << " B&B:" << bnds.getPrimal() << " HK:" << best << "\n";
+      if (bnds.getPrimal() != best || !engine.proved()) abort();
+   }
+   return 0;
+}
+
+// A knapsack whose paths may stop at item `stopFrom` or later (label 2) and cash the remaining capacity.
+// The last exact layer is the cutset only when no path stops above it. B&B proves the DP optimum either way.
+int t2(unsigned seed,int stopFrom) {
+   Knapsack ks(seed,20,200);
+   std::vector<std::vector<int>> dp(ks.I + 1,std::vector<int>(ks.capa + 1,0)); // item,capacity -> best
+   for(int i=ks.I-1;i >= 0;i--)
+      for(int c=0;c <= ks.capa;c++) {
+         dp[i][c] = std::max(dp[i+1][c],i >= stopFrom ? c : 0);
+         if (ks.w[i] <= c)
+            dp[i][c] = std::max(dp[i][c],dp[i+1][c - ks.w[i]] + ks.p[i]);
+      }
+   const int best = dp[0][ks.capa];
+   const auto init   = [&ks]() { return SKS {0,ks.capa};};
+   const auto target = [&ks]() { return SKS {ks.I,0};};
+   const auto lgf = [&ks,stopFrom](const SKS& s,DDContext) {
+      GNSet out {};
+      out.insert(0);
+      if (s.c >= ks.w[s.n]) out.insert(1);
+      if (s.n >= stopFrom)  out.insert(2);
+      return out;
+   };
+   const auto stf = [&ks](const SKS& s,const int label) -> std::optional<SKS> {
+      if (label == 2 || s.n == ks.I-1)
+         return SKS { ks.I,0 };
+      else return SKS { s.n+1,s.c - label * ks.w[s.n] };
+   };
+   const auto scf = [&ks](const SKS& s,int label) { return label == 2 ? s.c : ks.p[s.n] * label;};
+   const auto smf = [](const SKS& s1,const SKS& s2) -> std::optional<SKS> {
+      return SKS { std::max(s1.n,s2.n),std::max(s1.c,s2.c) };
+   };
+   const auto sEq = [&ks](const SKS& s) -> bool { return s.n == ks.I;};
+   auto theDD = DD<SKS,Maximize<double>,
+                   decltype(target),
+                   decltype(lgf),
+                   decltype(stf),
+                   decltype(scf),
+                   decltype(smf),
+                   decltype(sEq)
+                   >::makeDD(init,target,lgf,stf,scf,smf,sEq,GNSet(0,2));
+   Relaxed rel(8);
+   rel.setCutSetType(CSLastExactLayer);
+   auto dd = theDD->duplicate();
+   dd->setStrategy(&rel);
+   Bounds root(dd);
+   dd->compute(root);
+   const auto cs = dd->computeCutSet(root);
+   const bool early = stopFrom < 4; // layers 0..3 hold at most 8 states: exact at width 8
+   std::cout << "SEED:" << seed << " STOP@" << stopFrom << " LEL CUT:" << rel.lastExactCut()
+             << " |CS|:" << cs.size() << "\n";
+   if (cs.empty() || rel.lastExactCut() == early) abort();
+   if (!early && !std::all_of(cs.begin(),cs.end(),[l = cs[0]->getLayer()](ANode::Ptr n) { return n->getLayer() == l;}))
+      abort();
+   Bounds bnds;
+   BAndB engine(theDD,8);
+   engine.setCutSet(CSLastExactLayer);
+   engine.search(bnds);
+   std::cout << "SEED:" << seed << " STOP@" << stopFrom << " B&B:" << bnds.getPrimal() << " DP:" << best << "\n";
+   if (bnds.getPrimal() != best || !engine.proved()) abort();
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 3;s++) {
+      t0(s);
+      t1(s);
+      t2(s,0);
+      t2(s,15);
+   }
+}
@@ -0,0 +1,36 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include "knapsack.hpp"
+
+// Work stealing: 1 to 8 workers prove the DP optimum and leave no node behind. Stopped early,
+// the dual they report still bounds the optimum.
+int t0(unsigned seed) {
+   Knapsack ks(seed,50,500,true); // correlated: enough open nodes to steal
+   const int best = knapsackDP(ks);
+   auto theDD = makeKnapsackDD(ks,true);
+   for(unsigned nbw : { 1u,2u,4u,8u }) {
+      Bounds bnds = ks.checkedBounds();
+      BAndB engine(theDD,8,nbw);
+      engine.search(bnds);
+      std::cout << "SEED:" << seed << " WORKERS:" << nbw << " B&B:" << bnds.getPrimal() << " DP:" << best << "\n";
+      if (bnds.getPrimal() != best || !engine.proved() || engine.nbLiveNodes() != 0) abort();
+
+      std::atomic<unsigned> nbCalls = 0;
+      Bounds part = ks.checkedBounds();
+      BAndB stopped(theDD,8,nbw);
+      stopped.setTimeLimit([&nbCalls](double) { return ++nbCalls > 60;});
+      stopped.search(part);
+      std::cout << "SEED:" << seed << " WORKERS:" << nbw << " STOPPED DUAL:" << part.getDual() << "\n";
+      if (!part.hasDual() || part.getDual() < best || (part.hasPrimal() && part.getPrimal() > best)) abort();
+   }
+   return 0;
+}
+
+int main()
+{
+   for(unsigned s=1;s <= 2;s++)
+      t0(s);
+}
@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "domindex.hpp"
+
+// Knapsack like states <n,c>: a dominates b iff a.n == b.n && a.c >= b.c
+struct KS {
+   int n,c;
+};
+
+DomKey keyOf(const KS* s) { return DomKey { (std::size_t)s->n,(double)s->c};}
+bool dom(const KS* a,const KS* b) { return a->n == b->n && a->c >= b->c;}
+
+int t0() {
+   KS s[] = {{1,10},{1,20},{1,30},{2,50}};
+   DomIndex<const KS*> dix;
+   for(const auto& k : s)
+      dix.insert(keyOf(&k),&k);
+   KS q {1,15};
+   auto d = dix.findDominator(keyOf(&q),[&q](const KS* o) { return dom(o,&q);});
+   std::cout << "DOMINATOR of <1,15> = <" << d->n << ',' << d->c << ">\n";
+   if (d != s+1) abort();
+   int nb = 0;
+   dix.forDominated(keyOf(&q),[&q,&nb](const KS* o) { nb += dom(&q,o);});
+   std::cout << "#DOMINATED by <1,15> = " << nb << "\n";
+   if (nb != 1) abort();
+   KS q2 {2,60};
+   if (dix.findDominator(keyOf(&q2),[&q2](const KS* o) { return dom(o,&q2);}) != nullptr) abort();
+   return 0;
+}
+
+int t1() {
+   KS s[] = {{1,10},{1,10},{1,30}};
+   DomIndex<const KS*> dix;
+   for(const auto& k : s)
+      dix.insert(keyOf(&k),&k);
+   if (!dix.remove(keyOf(s+1),[&s](const KS* o) { return o == s+1;})) abort();
+   if (dix.remove(keyOf(s+1),[&s](const KS* o) { return o == s+1;})) abort();
+   std::cout << "SIZE after remove = " << dix.size() << "\n";
+   if (dix.size() != 2) abort();
+   KS q {1,5};
+   int nb = 0;
+   dix.forDominated(keyOf(&q),[&nb](const KS* o) { nb++;});
+   if (nb != 0) abort();
+   return 0;
+}
+
+int t2() {  // bounded scans: closest ranks first, stop on the first rejected entry
+   KS s[] = {{1,10},{1,20},{1,30},{1,40}};
+   DomIndex<const KS*> dix;
+   for(const auto& k : s)
+      dix.insert(keyOf(&k),&k);
+   KS q {1,35};
+   std::vector<int> seen;
+   dix.forDominated(keyOf(&q),[&seen](const KS* o) { seen.push_back(o->c);},[](const KS* o) { return o->c < 20;});
+   std::cout << "#VISITED below <1,35> = " << seen.size() << "\n";
+   if (seen != std::vector<int> {30,20}) abort();
+   KS q2 {1,15};
+   auto d = dix.findDominator(keyOf(&q2),[](const KS* o) { return o->c >= 40;},[](const KS* o) { return o->c > 30;});
+   if (d != nullptr) abort();
+   d = dix.findDominator(keyOf(&q2),[](const KS* o) { return o->c >= 30;},[](const KS* o) { return o->c > 30;});
+   if (d != s+2) abort();
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+   t2();
+}
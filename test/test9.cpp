@@ -0,0 +1,39 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include "cache.hpp"
+
+int t0() {
+   ClockCache<int,double> c(3);
+   for(int i=0;i < 3;i++)
+      c.insert(i,i * 10.0);
+   auto v = c.find(1);
+   if (!v || *v != 10.0) abort();
+   *v = 5.0;
+   c.find(0);
+   c.insert(3,30.0);  // 0 and 1 get a second chance, 2 is evicted
+   std::cout << "CACHE:" << c << "\n";
+   if (c.size() != 3) abort();
+   if (c.find(2) != nullptr) abort();
+   if (!c.find(1) || *c.find(1) != 5.0) abort();
+   if (!c.find(3)) abort();
+   if (c.evicted() != 1) abort();
+   return 0;
+}
+
+int t1() {
+   ClockCache<int,int> c;  // unbounded
+   for(int i=0;i < 1000;i++)
+      c.insert(i,i);
+   if (c.size() != 1000) abort();
+   c.setCapacity(10);
+   std::cout << "SHRUNK:" << c << "\n";
+   if (c.size() != 10 || c.find(999) == nullptr || c.find(0) != nullptr) abort();
+   return 0;
+}
+
+int main()
+{
+   t0();
+   t1();
+}